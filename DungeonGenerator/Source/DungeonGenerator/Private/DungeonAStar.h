@@ -0,0 +1,166 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A* search over any state with GetTypeHash and operator==. Nodes live in an arena and point to their parent by index,
+ * so paths are rebuilt by walking parents instead of copied into every node. The open list is a binary heap that knows
+ * where each node sits in it, a cheaper path to an open node moves it up in place, and a hash map finds the node of a
+ * state. The caller drives the search: pop the best open node, expand it, relax its neighbours.
+ * With a zero heuristic it is Dijkstra.
+ */
+template<typename StateType>
+class TDungeonAStar
+{
+public:
+	struct FNode
+	{
+		StateType State;
+		int32 Parent = INDEX_NONE;
+		//Nodes on the path up to this one, 1 for a start node
+		int32 Depth = 1;
+		double G = 0.0;
+		double F = 0.0;
+		//Position in the open heap, INDEX_NONE once closed
+		int32 HeapIndex = INDEX_NONE;
+	};
+
+	void Reset()
+	{
+		Nodes.Reset();
+		NodeIndices.Reset();
+		OpenHeap.Reset();
+	}
+
+	/** Opens a node with no parent. */
+	int32 AddStart(const StateType& State, double G, double H)
+	{
+		return Relax(INDEX_NONE, State, G, H);
+	}
+
+	/** Opens State from ParentIdx, or moves its open node if G is cheaper. Returns the node, INDEX_NONE when State was
+	 * closed already or reached as cheaply before. */
+	int32 Relax(int32 ParentIdx, const StateType& State, double G, double H)
+	{
+		const int32 Depth = ParentIdx != INDEX_NONE ? Nodes[ParentIdx].Depth + 1 : 1;
+		if(const int32* ExistingIdx = NodeIndices.Find(State))
+		{
+			FNode& Node = Nodes[*ExistingIdx];
+			if(Node.HeapIndex == INDEX_NONE || G >= Node.G)
+			{
+				return INDEX_NONE;
+			}
+			Node.Parent = ParentIdx;
+			Node.Depth = Depth;
+			Node.G = G;
+			Node.F = G + H;
+			SiftUp(Node.HeapIndex);
+			return *ExistingIdx;
+		}
+
+		const int32 NodeIdx = Nodes.Num();
+		FNode& Node = Nodes.AddDefaulted_GetRef();
+		Node.State = State;
+		Node.Parent = ParentIdx;
+		Node.Depth = Depth;
+		Node.G = G;
+		Node.F = G + H;
+		Node.HeapIndex = OpenHeap.Add(NodeIdx);
+		NodeIndices.Add(State, NodeIdx);
+		SiftUp(Node.HeapIndex);
+		return NodeIdx;
+	}
+
+	/** Closes and returns the open node with the lowest F, the oldest one on ties. INDEX_NONE when none is left. */
+	int32 PopOpen()
+	{
+		if(OpenHeap.IsEmpty())
+		{
+			return INDEX_NONE;
+		}
+		const int32 NodeIdx = OpenHeap[0];
+		const int32 LastIdx = OpenHeap.Pop(EAllowShrinking::No);
+		if(!OpenHeap.IsEmpty())
+		{
+			OpenHeap[0] = LastIdx;
+			Nodes[LastIdx].HeapIndex = 0;
+			SiftDown(0);
+		}
+		Nodes[NodeIdx].HeapIndex = INDEX_NONE;
+		return NodeIdx;
+	}
+
+	bool HasOpenNodes() const { return !OpenHeap.IsEmpty(); }
+	int32 GetNumOpen() const { return OpenHeap.Num(); }
+	int32 GetNumClosed() const { return Nodes.Num() - OpenHeap.Num(); }
+	int32 GetNumNodes() const { return Nodes.Num(); }
+	const FNode& GetNode(int32 NodeIdx) const { return Nodes[NodeIdx]; }
+
+	/** States from the start of the path to NodeIdx. */
+	void GetPath(int32 NodeIdx, TArray<StateType>& OutPath) const
+	{
+		OutPath.SetNumUninitialized(Nodes[NodeIdx].Depth);
+		for (int32 PathIdx = OutPath.Num() - 1; NodeIdx != INDEX_NONE; --PathIdx)
+		{
+			OutPath[PathIdx] = Nodes[NodeIdx].State;
+			NodeIdx = Nodes[NodeIdx].Parent;
+		}
+	}
+
+private:
+	bool IsBefore(int32 NodeA, int32 NodeB) const
+	{
+		return Nodes[NodeA].F < Nodes[NodeB].F || (Nodes[NodeA].F == Nodes[NodeB].F && NodeA < NodeB);
+	}
+
+	void SiftUp(int32 HeapIdx)
+	{
+		const int32 NodeIdx = OpenHeap[HeapIdx];
+		while (HeapIdx > 0)
+		{
+			const int32 ParentHeapIdx = (HeapIdx - 1) / 2;
+			if(!IsBefore(NodeIdx, OpenHeap[ParentHeapIdx]))
+			{
+				break;
+			}
+			OpenHeap[HeapIdx] = OpenHeap[ParentHeapIdx];
+			Nodes[OpenHeap[HeapIdx]].HeapIndex = HeapIdx;
+			HeapIdx = ParentHeapIdx;
+		}
+		OpenHeap[HeapIdx] = NodeIdx;
+		Nodes[NodeIdx].HeapIndex = HeapIdx;
+	}
+
+	void SiftDown(int32 HeapIdx)
+	{
+		const int32 NodeIdx = OpenHeap[HeapIdx];
+		while (true)
+		{
+			int32 ChildHeapIdx = HeapIdx * 2 + 1;
+			if(ChildHeapIdx >= OpenHeap.Num())
+			{
+				break;
+			}
+			if(ChildHeapIdx + 1 < OpenHeap.Num() && IsBefore(OpenHeap[ChildHeapIdx + 1], OpenHeap[ChildHeapIdx]))
+			{
+				++ChildHeapIdx;
+			}
+			if(!IsBefore(OpenHeap[ChildHeapIdx], NodeIdx))
+			{
+				break;
+			}
+			OpenHeap[HeapIdx] = OpenHeap[ChildHeapIdx];
+			Nodes[OpenHeap[HeapIdx]].HeapIndex = HeapIdx;
+			HeapIdx = ChildHeapIdx;
+		}
+		OpenHeap[HeapIdx] = NodeIdx;
+		Nodes[NodeIdx].HeapIndex = HeapIdx;
+	}
+
+	TArray<FNode> Nodes;
+	TMap<StateType, int32> NodeIndices;
+	//Indices into Nodes
+	TArray<int32> OpenHeap;
+};
@@ -0,0 +1,308 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonBenchmarkCommandlet.h"
+
+#include "Async/Async.h"
+#include "DungeonLayout.h"
+#include "DungeonMapper.h"
+#include "DungeonTriangulator.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+#include <atomic>
+
+namespace DungeonBenchmark
+{
+	constexpr double BytesToMB = 1.0 / (1024.0 * 1024.0);
+	//Vertical cells the rooms are spread over, the horizontal ones grow with the room count
+	constexpr int32 ZCells = 2;
+	//Spare cells per room so room spawning never runs out of free cells
+	constexpr int32 CellsPerRoom = 2;
+	//Seconds between used physical memory samples while a stage runs
+	constexpr float MemorySamplingInterval = 0.001f;
+
+	/** Polls the used physical memory on its own thread while alive, so memory a stage frees before returning still counts. */
+	class FPeakMemorySampler
+	{
+	public:
+		FPeakMemorySampler()
+		{
+			Sampler = Async(EAsyncExecution::Thread, [this]()
+			{
+				uint64 PeakUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+				while (!bStop)
+				{
+					FPlatformProcess::Sleep(MemorySamplingInterval);
+					PeakUsedPhysical = FMath::Max(PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+				}
+				return PeakUsedPhysical;
+			});
+		}
+
+		/** Stops sampling. Returns the highest used physical memory seen. */
+		uint64 Stop()
+		{
+			bStop = true;
+			return Sampler.Get();
+		}
+
+	private:
+		std::atomic<bool> bStop = false;
+		TFuture<uint64> Sampler;
+	};
+}
+
+UDungeonBenchmarkCommandlet::UDungeonBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDungeonBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	const TArray<int32> RoomCounts = ParseIntList(ParamVals.Contains(TEXT("Rooms")) ? ParamVals[TEXT("Rooms")] : TEXT("10,100,1000,10000"));
+	const TArray<int32> Seeds = ParseIntList(ParamVals.Contains(TEXT("Seeds")) ? ParamVals[TEXT("Seeds")] : TEXT("1,2,3"));
+
+	TArray<EHallwayGenerationMethod> HallwayMethods;
+	const FString MethodList = ParamVals.Contains(TEXT("Methods")) ? ParamVals[TEXT("Methods")] : TEXT("Basic,PathFinding");
+	TArray<FString> MethodNames;
+	MethodList.ParseIntoArray(MethodNames, TEXT(","));
+	for (const FString& MethodName : MethodNames)
+	{
+		const int64 MethodValue = StaticEnum<EHallwayGenerationMethod>()->GetValueByNameString(MethodName);
+		if(MethodValue == INDEX_NONE)
+		{
+			UE_LOG(LogDungeonGenerator, Error, TEXT("Unknown hallway generation method %s"), *MethodName);
+			return 1;
+		}
+		HallwayMethods.Add(static_cast<EHallwayGenerationMethod>(MethodValue));
+	}
+
+	TArray<ETriangulationBackend> TriangulationBackends;
+	const FString BackendList = ParamVals.Contains(TEXT("Backends")) ? ParamVals[TEXT("Backends")] : TEXT("Auto");
+	TArray<FString> BackendNames;
+	BackendList.ParseIntoArray(BackendNames, TEXT(","));
+	for (const FString& BackendName : BackendNames)
+	{
+		const int64 BackendValue = StaticEnum<ETriangulationBackend>()->GetValueByNameString(BackendName);
+		if(BackendValue == INDEX_NONE)
+		{
+			UE_LOG(LogDungeonGenerator, Error, TEXT("Unknown triangulation backend %s"), *BackendName);
+			return 1;
+		}
+		TriangulationBackends.Add(static_cast<ETriangulationBackend>(BackendValue));
+	}
+
+	if(const FString* PlacementName = ParamVals.Find(TEXT("Placement")))
+	{
+		const int64 PlacementValue = StaticEnum<ERoomPlacementMethod>()->GetValueByNameString(*PlacementName);
+		if(PlacementValue == INDEX_NONE)
+		{
+			UE_LOG(LogDungeonGenerator, Error, TEXT("Unknown room placement method %s"), **PlacementName);
+			return 1;
+		}
+		RoomPlacementMethod = static_cast<ERoomPlacementMethod>(PlacementValue);
+	}
+
+	bRender = !Switches.Contains(TEXT("NoRender"));
+	bApplyNodeRepulsion = Switches.Contains(TEXT("Repulsion"));
+	const FString OutputFile = ParamVals.Contains(TEXT("Output"))
+		? ParamVals[TEXT("Output")]
+		: FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("DungeonBenchmark-%s.csv"), *FDateTime::Now().ToString());
+
+	//Rendering needs a world to spawn the mapper and the rooms in
+	UWorld* World = nullptr;
+	ADungeonMapper* DungeonMapper = nullptr;
+	if(bRender)
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("DungeonBenchmark"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		DungeonMapper = World->SpawnActor<ADungeonMapper>();
+		DungeonMapper->RoomData = NewObject<UDungeonRoomData>(DungeonMapper);
+		DungeonMapper->RoomData->WallThickness = 20.0f;
+		DungeonMapper->RoomData->DoorMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		DungeonMapper->HallwayData = NewObject<UDungeonHallwayData>(DungeonMapper);
+		DungeonMapper->HallwayData->WallThickness = 20.0f;
+		DungeonMapper->HallwayData->HallWaySectionDimensions = HallWaySectionDimensions;
+	}
+
+	TArray<FString> CSVLines;
+	CSVLines.Add(TEXT("Rooms,HallwayMethod,Seed,TriangulationBackend,GeneratedRooms,Tetrahedra,Connections,ReferenceConnectionsMatched,SimplifiedConnections,HallwaySegments,Triangles,")
+		TEXT("GenerateRoomsMs,ConnectRoomsMs,CollapseMs,SimplifyConnectionsMs,CreateHallwaysMs,RenderDungeonMs,RunPeakUsedPhysicalAboveBaseMB,ProcessPeakUsedPhysicalMB"));
+
+	for (const int32 Rooms : RoomCounts)
+	{
+		for (const EHallwayGenerationMethod HallwayMethod : HallwayMethods)
+		{
+			for (const int32 Seed : Seeds)
+			{
+				TArray<uint64> ReferenceConnections;
+				for (int32 BackendIdx = 0; BackendIdx < TriangulationBackends.Num(); ++BackendIdx)
+				{
+					FBenchmarkRun Run;
+					Run.Rooms = Rooms;
+					Run.HallwayMethod = HallwayMethod;
+					Run.Seed = Seed;
+					Run.TriangulationBackend = TriangulationBackends[BackendIdx];
+					TArray<uint64> Connections;
+					CSVLines.Add(RunBenchmark(Run, DungeonMapper, BackendIdx > 0 ? &ReferenceConnections : nullptr, Connections));
+					UE_LOG(LogDungeonGenerator, Display, TEXT("%s"), *CSVLines.Last());
+					if(BackendIdx == 0)
+					{
+						ReferenceConnections = MoveTemp(Connections);
+					}
+				}
+			}
+		}
+	}
+
+	if(World)
+	{
+		DungeonMapper->ClearAll();
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	if(!FFileHelper::SaveStringArrayToFile(CSVLines, *OutputFile))
+	{
+		UE_LOG(LogDungeonGenerator, Error, TEXT("Couldn't write benchmark results to %s"), *OutputFile);
+		return 1;
+	}
+	UE_LOG(LogDungeonGenerator, Display, TEXT("Benchmark results written to %s"), *OutputFile);
+	return 0;
+}
+
+FString UDungeonBenchmarkCommandlet::RunBenchmark(const FBenchmarkRun& Run, ADungeonMapper* DungeonMapper, const TArray<uint64>* ReferenceConnections, TArray<uint64>& OutConnections) const
+{
+	//Rooms and meshes rendered by the previous run are only freed by the garbage collector, so the base doesn't drift up
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	const uint64 BaseUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	uint64 RunPeakUsedPhysical = BaseUsedPhysical;
+	auto TimeStage = [&RunPeakUsedPhysical](TFunctionRef<void()> Stage)
+	{
+		DungeonBenchmark::FPeakMemorySampler MemorySampler;
+		const double StartTime = FPlatformTime::Seconds();
+		Stage();
+		const double StageTime = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		RunPeakUsedPhysical = FMath::Max(RunPeakUsedPhysical, MemorySampler.Stop());
+		return StageTime;
+	};
+
+	FDungeonLayout Layout(MakeSettings(Run));
+	const double GenerateRoomsTime = TimeStage([&Layout]() { Layout.GenerateRooms(); });
+	const double ConnectRoomsTime = TimeStage([&Layout]() { Layout.ConnectRooms(); });
+	const int32 Connections = Layout.DungeonConnections.Num();
+	OutConnections.Reset(Connections);
+	for (const FDungeonConnection& Connection : Layout.DungeonConnections)
+	{
+		OutConnections.Add(FDungeonTriangulator::MakeEdge(Connection.StartRoom, Connection.EndRoom));
+	}
+	FDungeonTriangulator::SortUniqueEdges(OutConnections);
+	//Both lists are sorted, so the shared connections come out of a single merge
+	int32 ReferenceConnectionsMatched = OutConnections.Num();
+	if(ReferenceConnections)
+	{
+		ReferenceConnectionsMatched = 0;
+		for (int32 ConnectionIdx = 0, ReferenceIdx = 0; ConnectionIdx < OutConnections.Num() && ReferenceIdx < ReferenceConnections->Num();)
+		{
+			const uint64 Connection = OutConnections[ConnectionIdx];
+			const uint64 Reference = (*ReferenceConnections)[ReferenceIdx];
+			ReferenceConnectionsMatched += Connection == Reference ? 1 : 0;
+			ConnectionIdx += Connection <= Reference ? 1 : 0;
+			ReferenceIdx += Reference <= Connection ? 1 : 0;
+		}
+	}
+	const double CollapseTime = TimeStage([&Layout]() { Layout.Collapse(); });
+	const double SimplifyConnectionsTime = TimeStage([&Layout]() { Layout.SimplifyConnections(); });
+	const double CreateHallwaysTime = TimeStage([&Layout]() { Layout.CreateHallways(); });
+
+	const int32 GeneratedRooms = Layout.DungeonNodes.Num();
+	const int32 Tetrahedra = Layout.TetrahedronCount;
+	const int32 SimplifiedConnections = Layout.DungeonConnections.Num();
+	const int32 HallwaySegments = Layout.DungeonHallways.Num();
+
+	double RenderDungeonTime = 0.0;
+	int32 Triangles = 0;
+	if(DungeonMapper)
+	{
+		DungeonMapper->SetLayout(MoveTemp(Layout));
+		RenderDungeonTime = TimeStage([DungeonMapper]() { DungeonMapper->RenderDungeon(); });
+		Triangles = DungeonMapper->GetRenderedTriangleCount();
+		DungeonMapper->ClearAll();
+	}
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	const double RunPeakUsedPhysicalAboveBaseMB = (RunPeakUsedPhysical - BaseUsedPhysical) * DungeonBenchmark::BytesToMB;
+	return FString::Printf(TEXT("%d,%s,%d,%s,%d,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f")
+		, Run.Rooms
+		, *StaticEnum<EHallwayGenerationMethod>()->GetNameStringByValue(static_cast<int64>(Run.HallwayMethod))
+		, Run.Seed
+		, *StaticEnum<ETriangulationBackend>()->GetNameStringByValue(static_cast<int64>(Run.TriangulationBackend))
+		, GeneratedRooms
+		, Tetrahedra
+		, Connections
+		, ReferenceConnectionsMatched
+		, SimplifiedConnections
+		, HallwaySegments
+		, Triangles
+		, GenerateRoomsTime
+		, ConnectRoomsTime
+		, CollapseTime
+		, SimplifyConnectionsTime
+		, CreateHallwaysTime
+		, RenderDungeonTime
+		, RunPeakUsedPhysicalAboveBaseMB
+		, MemoryStats.PeakUsedPhysical * DungeonBenchmark::BytesToMB);
+}
+
+FDungeonLayoutSettings UDungeonBenchmarkCommandlet::MakeSettings(const FBenchmarkRun& Run) const
+{
+	FDungeonLayoutSettings Settings;
+	Settings.MinRooms = Run.Rooms;
+	Settings.MaxRooms = Run.Rooms;
+	Settings.RoomXExtent = RoomXExtent;
+	Settings.RoomYExtent = RoomYExtent;
+	Settings.RoomZExtent = RoomZExtent;
+	Settings.RandomSeed = Run.Seed;
+	Settings.RoomPlacementMethod = RoomPlacementMethod;
+	Settings.TriangulationBackend = Run.TriangulationBackend;
+	Settings.HallWayGenerationMethod = Run.HallwayMethod;
+	Settings.HallWaySectionDimensions = HallWaySectionDimensions;
+	Settings.bPreventCrossing = true;
+	Settings.bCreateCorners = true;
+	Settings.bApplyNodeRepulsion = bApplyNodeRepulsion;
+	Settings.bApplySpringForce = true;
+
+	//Grow the spawn area with the room count so every run has the same room density
+	const int32 HorizontalCells = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Run.Rooms * DungeonBenchmark::CellsPerRoom) / DungeonBenchmark::ZCells));
+	const FVector BoundsExtent(HorizontalCells * RoomXExtent.Y, HorizontalCells * RoomYExtent.Y, DungeonBenchmark::ZCells * RoomZExtent.Y);
+	Settings.Bounds = FBox(-BoundsExtent, BoundsExtent);
+	return Settings;
+}
+
+TArray<int32> UDungeonBenchmarkCommandlet::ParseIntList(const FString& List)
+{
+	TArray<FString> Entries;
+	List.ParseIntoArray(Entries, TEXT(","));
+	TArray<int32> Values;
+	for (const FString& Entry : Entries)
+	{
+		Values.Add(FCString::Atoi(*Entry));
+	}
+	return Values;
+}
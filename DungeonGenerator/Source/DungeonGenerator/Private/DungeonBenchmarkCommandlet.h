@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DungeonMapperData.h"
+#include "DungeonBenchmarkCommandlet.generated.h"
+
+class ADungeonMapper;
+struct FDungeonLayoutSettings;
+
+/**
+ * Runs every generation stage headlessly over a matrix of room counts, hallway methods, seeds and triangulation
+ * backends, and writes the time spent per stage, memory use and output sizes to a CSV file. The connections of every
+ * backend are compared against the ones of the first backend listed for the same run.
+ *
+ * RunPeakUsedPhysicalAboveBaseMB is the highest used physical memory sampled while the run's stages execute, minus the
+ * memory used once garbage is collected before the run. ProcessPeakUsedPhysicalMB is the process high-water mark.
+ *
+ * Usage: UnrealEditor-Cmd.exe <Project> -run=DungeonBenchmark -nullrhi [-Rooms=10,100,1000,10000] [-Seeds=1,2,3]
+ *        [-Methods=Basic,PathFinding] [-Placement=ShuffledCell] [-Backends=BowyerWatson,ParallelBowyerWatson,GeometryCore]
+ *        [-NoRender] [-Repulsion] [-Output=<File.csv>]
+ *
+ * Node repulsion is off unless -Repulsion is given, it makes every collapse iteration quadratic in the room count.
+ */
+UCLASS()
+class UDungeonBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDungeonBenchmarkCommandlet();
+
+	//Override - UCommandlet - START
+	virtual int32 Main(const FString& Params) override;
+	//Override - UCommandlet - END
+
+private:
+	struct FBenchmarkRun
+	{
+		int32 Rooms = 0;
+		EHallwayGenerationMethod HallwayMethod = EHallwayGenerationMethod::Basic;
+		int32 Seed = 0;
+		ETriangulationBackend TriangulationBackend = ETriangulationBackend::Auto;
+	};
+
+	/** ReferenceConnections are the sorted connection keys to compare with, null to skip. OutConnections gets this run's. */
+	FString RunBenchmark(const FBenchmarkRun& Run, ADungeonMapper* DungeonMapper, const TArray<uint64>* ReferenceConnections, TArray<uint64>& OutConnections) const;
+	FDungeonLayoutSettings MakeSettings(const FBenchmarkRun& Run) const;
+
+	static TArray<int32> ParseIntList(const FString& List);
+
+private:
+	FVector2D RoomXExtent = FVector2D(200.0f, 400.0f);
+	FVector2D RoomYExtent = FVector2D(200.0f, 400.0f);
+	FVector2D RoomZExtent = FVector2D(150.0f, 200.0f);
+	FVector2D HallWaySectionDimensions = FVector2D(150.0f, 200.0f);
+	ERoomPlacementMethod RoomPlacementMethod = ERoomPlacementMethod::ShuffledCell;
+	bool bRender = true;
+	bool bApplyNodeRepulsion = false;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonGenerationAsyncAction.h"
+
+#include "DungeonMapper.h"
+
+UDungeonGenerationAsyncAction* UDungeonGenerationAsyncAction::GenerateDungeonAsync(ADungeonMapper* DungeonMapper)
+{
+	UDungeonGenerationAsyncAction* Action = NewObject<UDungeonGenerationAsyncAction>();
+	Action->DungeonMapper = DungeonMapper;
+	if(DungeonMapper)
+	{
+		Action->RegisterWithGameInstance(DungeonMapper);
+	}
+	return Action;
+}
+
+void UDungeonGenerationAsyncAction::Activate()
+{
+	ADungeonMapper* Mapper = DungeonMapper.Get();
+	if(!Mapper)
+	{
+		Finish(false);
+		return;
+	}
+
+	Mapper->OnDungeonGenerated.AddDynamic(this, &UDungeonGenerationAsyncAction::OnDungeonGenerated);
+	Mapper->OnEndPlay.AddDynamic(this, &UDungeonGenerationAsyncAction::OnDungeonMapperEndPlay);
+	if(!Mapper->GenerateDungeonAsync())
+	{
+		Finish(false);
+	}
+}
+
+void UDungeonGenerationAsyncAction::OnDungeonGenerated(ADungeonMapper* InDungeonMapper, bool bSuccess)
+{
+	Finish(bSuccess);
+}
+
+void UDungeonGenerationAsyncAction::OnDungeonMapperEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	Finish(false);
+}
+
+void UDungeonGenerationAsyncAction::Finish(bool bSuccess)
+{
+	ADungeonMapper* Mapper = DungeonMapper.Get();
+	if(Mapper)
+	{
+		Mapper->OnDungeonGenerated.RemoveDynamic(this, &UDungeonGenerationAsyncAction::OnDungeonGenerated);
+		Mapper->OnEndPlay.RemoveDynamic(this, &UDungeonGenerationAsyncAction::OnDungeonMapperEndPlay);
+	}
+
+	if(bSuccess)
+	{
+		Completed.Broadcast(Mapper);
+	}
+	else
+	{
+		Failed.Broadcast(Mapper);
+	}
+	SetReadyToDestroy();
+}
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "DungeonGenerationAsyncAction.generated.h"
+
+class ADungeonMapper;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDungeonGenerationActionFinished, ADungeonMapper*, DungeonMapper);
+
+/** Latent Blueprint node wrapping ADungeonMapper::GenerateDungeonAsync. */
+UCLASS()
+class UDungeonGenerationAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Mapper|Generators", meta = (BlueprintInternalUseOnly = "true", DisplayName = "Generate Dungeon Async"))
+	static UDungeonGenerationAsyncAction* GenerateDungeonAsync(ADungeonMapper* DungeonMapper);
+
+	//Override - UBlueprintAsyncActionBase - START
+	virtual void Activate() override;
+	//Override - UBlueprintAsyncActionBase - END
+
+private:
+	UFUNCTION()
+	void OnDungeonGenerated(ADungeonMapper* InDungeonMapper, bool bSuccess);
+	/** The mapper won't finish the generation once it's destroyed or streamed out. */
+	UFUNCTION()
+	void OnDungeonMapperEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+	void Finish(bool bSuccess);
+
+public:
+	UPROPERTY(BlueprintAssignable)
+	FOnDungeonGenerationActionFinished Completed;
+	UPROPERTY(BlueprintAssignable)
+	FOnDungeonGenerationActionFinished Failed;
+
+private:
+	UPROPERTY()
+	TWeakObjectPtr<ADungeonMapper> DungeonMapper;
+};
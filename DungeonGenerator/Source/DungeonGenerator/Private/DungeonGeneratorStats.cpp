@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonGeneratorStats.h"
+
+DEFINE_LOG_CATEGORY(LogDungeonGenerator);
+
+// PROFILER INTEGRATION //
+DEFINE_STAT(STAT_GenerateRooms);
+DEFINE_STAT(STAT_ConnectRooms);
+DEFINE_STAT(STAT_SimplifyConections);
+DEFINE_STAT(STAT_Collapse);
+DEFINE_STAT(STAT_CreateHallways);
+DEFINE_STAT(STAT_CreateHallwaysFromPath);
+DEFINE_STAT(STAT_FinishHallways);
+DEFINE_STAT(STAT_PathFinderEvaluate);
+
+DEFINE_STAT(STAT_RenderDungeon);
+DEFINE_STAT(STAT_RenderHallways);
+DEFINE_STAT(STAT_InitializeRoom);
+DEFINE_STAT(STAT_CreateDoors);
+DEFINE_STAT(STAT_AppendHallowedBox);
+DEFINE_STAT(STAT_AppendHallwayCorner);
+DEFINE_STAT(STAT_AppendHallway);
+
+DEFINE_STAT(STAT_RoomCount);
+DEFINE_STAT(STAT_TetrahedronCount);
+DEFINE_STAT(STAT_ConnectionCount);
+DEFINE_STAT(STAT_HallwaySegmentCount);
+DEFINE_STAT(STAT_PathFinderOpenNodes);
+DEFINE_STAT(STAT_PathFinderClosedNodes);
+DEFINE_STAT(STAT_BooleanOperations);
+DEFINE_STAT(STAT_TriangleCount);
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDungeonGenerator, Log, All);
+
+// PROFILER INTEGRATION //
+DECLARE_STATS_GROUP(TEXT("Procedural Dungeon"), STATGROUP_ProcDungeon, STATCAT_DungeonMapper);
+
+//Layout stages
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Generate Rooms"), STAT_GenerateRooms, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Connect Rooms"), STAT_ConnectRooms, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Simplify Connections"), STAT_SimplifyConections, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Collapse"), STAT_Collapse, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Create Hallways"), STAT_CreateHallways, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Create Hallways From Path"), STAT_CreateHallwaysFromPath, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Finish Hallways"), STAT_FinishHallways, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Path Finder Evaluate"), STAT_PathFinderEvaluate, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+
+//Rendering
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Render Dungeon"), STAT_RenderDungeon, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Render Hallways"), STAT_RenderHallways, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Room / Initialize Room"), STAT_InitializeRoom, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Room / Create Doors"), STAT_CreateDoors, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Geometry / Append Hallowed Box"), STAT_AppendHallowedBox, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Geometry / Append Hallway Corner"), STAT_AppendHallwayCorner, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Geometry / Append Hallway"), STAT_AppendHallway, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+
+//Sizes, kept until the next generation or ClearAll. Path finder nodes add up every hallway search
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Rooms"), STAT_RoomCount, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Tetrahedra"), STAT_TetrahedronCount, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Connections"), STAT_ConnectionCount, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Hallway Segments"), STAT_HallwaySegmentCount, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Path Finder / Open Nodes"), STAT_PathFinderOpenNodes, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Path Finder / Closed Nodes"), STAT_PathFinderClosedNodes, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Boolean Operations"), STAT_BooleanOperations, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Triangles"), STAT_TriangleCount, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
+
+//Accumulates the time spent in the scope into Stat and opens a cpu scope of the same name for Insights captures
+#define SCOPE_DUNGEON_STAT(Stat) \
+	SCOPE_SECONDS_ACCUMULATOR(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
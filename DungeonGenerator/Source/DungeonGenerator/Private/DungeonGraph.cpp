@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonGraph.h"
+
+#include "DungeonMapperData.h"
+
+void FDungeonGraph::Build(int32 NumRooms, TConstArrayView<FDungeonConnection> Connections)
+{
+	Reset();
+	Offsets.Init(0, NumRooms + 1);
+	for (const FDungeonConnection& Connection : Connections)
+	{
+		++Offsets[Connection.StartRoom + 1];
+		++Offsets[Connection.EndRoom + 1];
+	}
+	for (int32 Room = 0; Room < NumRooms; ++Room)
+	{
+		Offsets[Room + 1] += Offsets[Room];
+	}
+
+	//Filled in connection order, every room ends with its connections ascending
+	TArray<int32> NextEntry(Offsets.GetData(), NumRooms);
+	Neighbours.SetNumUninitialized(Connections.Num() * 2);
+	RoomConnections.SetNumUninitialized(Connections.Num() * 2);
+	for (int32 ConnectionIdx = 0; ConnectionIdx < Connections.Num(); ++ConnectionIdx)
+	{
+		const FDungeonConnection& Connection = Connections[ConnectionIdx];
+		const int32 StartEntry = NextEntry[Connection.StartRoom]++;
+		Neighbours[StartEntry] = Connection.EndRoom;
+		RoomConnections[StartEntry] = ConnectionIdx;
+		const int32 EndEntry = NextEntry[Connection.EndRoom]++;
+		Neighbours[EndEntry] = Connection.StartRoom;
+		RoomConnections[EndEntry] = ConnectionIdx;
+	}
+}
+
+void FDungeonGraph::Reset()
+{
+	Offsets.Reset();
+	Neighbours.Reset();
+	RoomConnections.Reset();
+}
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDungeonConnection;
+
+/**
+ * Room adjacency in compressed sparse row form. The connections of every room sit next to each other, in ascending
+ * connection order, so traversing a room's neighbours reads two contiguous ranges and nothing points into the
+ * connection array. Rebuilt whenever the connections change.
+ */
+class DUNGEONGENERATOR_API FDungeonGraph
+{
+public:
+	void Build(int32 NumRooms, TConstArrayView<FDungeonConnection> Connections);
+	void Reset();
+
+	int32 GetNumRooms() const { return FMath::Max(Offsets.Num() - 1, 0); }
+	int32 GetNumConnections() const { return Neighbours.Num() / 2; }
+	int32 GetDegree(int32 Room) const { return Offsets[Room + 1] - Offsets[Room]; }
+	/** Rooms connected to Room. */
+	TConstArrayView<int32> GetNeighbours(int32 Room) const { return MakeArrayView(Neighbours.GetData() + Offsets[Room], GetDegree(Room)); }
+	/** Indices into the connections the graph was built from, matching GetNeighbours one to one. */
+	TConstArrayView<int32> GetConnections(int32 Room) const { return MakeArrayView(RoomConnections.GetData() + Offsets[Room], GetDegree(Room)); }
+
+private:
+	//Where the entries of each room start, with one extra offset for the end of the last room
+	TArray<int32> Offsets;
+	TArray<int32> Neighbours;
+	TArray<int32> RoomConnections;
+};
@@ -0,0 +1,1393 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonLayout.h"
+
+#include "Async/ParallelFor.h"
+#include "DungeonAStar.h"
+#include "DungeonTriangulationBackend.h"
+
+void FDungeonLayout::Generate()
+{
+	GenerateRooms();
+	ConnectRooms();
+	Collapse();
+	SimplifyConnections();
+	CreateHallways();
+}
+
+UE::Tasks::TTask<FDungeonLayout> FDungeonLayout::GenerateAsync(const FDungeonLayoutSettings& InSettings)
+{
+	return UE::Tasks::Launch(UE_SOURCE_LOCATION, [InSettings]()
+	{
+		FDungeonLayout Layout(InSettings);
+		Layout.Generate();
+		return Layout;
+	});
+}
+
+void FDungeonLayout::Reset()
+{
+	DungeonNodes.Empty();
+	DungeonConnections.Empty();
+	RoomGraph.Reset();
+	DungeonHallways.Empty();
+	DungeonBounds = FBox(ForceInit);
+	RoomBVH.Reset();
+	TetrahedronCount = 0;
+	CriticalPathLength = 0.0f;
+	CriticalPathRoomCount = 0;
+	bIsCollapsing = false;
+	bIsCreatingHallways = false;
+	RoomOccupancy.Reset();
+	HallwayOccupancy.Reset();
+}
+
+void FDungeonLayout::GenerateRooms()
+{
+	SCOPE_DUNGEON_STAT(STAT_GenerateRooms);
+	Reset();
+	DungeonNodes.Reserve(Settings.MaxRooms);
+	if(!Settings.Bounds.IsValid)
+	{
+		return;
+	}
+	DungeonBounds = Settings.Bounds;
+
+	FRandomStream RandomStream(Settings.RandomSeed);
+	if(Settings.RoomPlacementMethod == ERoomPlacementMethod::PoissonDisk)
+	{
+		PlaceRoomsPoissonDisk(RandomStream);
+	}
+	else
+	{
+		PlaceRoomsInCells(RandomStream);
+	}
+
+	FVector MinDungeonBounds = FVector::ZeroVector;
+	FVector MaxDungeonBounds = FVector::ZeroVector;
+	for (int32 i = 0; i < DungeonNodes.Num(); i++)
+	{
+		const FVector RoomMin = DungeonNodes[i].Location - DungeonNodes[i].Extent;
+		const FVector RoomMax = DungeonNodes[i].Location + DungeonNodes[i].Extent;
+
+		if(i==0)
+		{
+			MinDungeonBounds = RoomMin;
+			MaxDungeonBounds = RoomMax;
+		}
+		else
+		{
+			MinDungeonBounds.X = FMath::Min(RoomMin.X, MinDungeonBounds.X);
+			MinDungeonBounds.Y = FMath::Min(RoomMin.Y, MinDungeonBounds.Y);
+			MinDungeonBounds.Z = FMath::Min(RoomMin.Z, MinDungeonBounds.Z);
+
+			MaxDungeonBounds.X = FMath::Max(RoomMax.X, MaxDungeonBounds.X);
+			MaxDungeonBounds.Y = FMath::Max(RoomMax.Y, MaxDungeonBounds.Y);
+			MaxDungeonBounds.Z = FMath::Max(RoomMax.Z, MaxDungeonBounds.Z);
+		}
+	}
+	DungeonBounds = FBox(MinDungeonBounds, MaxDungeonBounds);
+	SET_DWORD_STAT(STAT_RoomCount, DungeonNodes.Num());
+}
+
+FVector FDungeonLayout::RandomRoomExtent(const FRandomStream& RandomStream) const
+{
+	const int32 RoomXSize = RandomStream.RandRange(Settings.RoomXExtent.X, Settings.RoomXExtent.Y);
+	const int32 RoomYSize = RandomStream.RandRange(Settings.RoomYExtent.X, Settings.RoomYExtent.Y);
+	const int32 RoomZSize = RandomStream.RandRange(Settings.RoomZExtent.X, Settings.RoomZExtent.Y);
+	return FVector(RoomXSize, RoomYSize, RoomZSize);
+}
+
+void FDungeonLayout::PlaceRoomsInCells(const FRandomStream& RandomStream)
+{
+	//Divde spawn area in equal spaced cells of max size of rooms
+	const int32 XCells = DungeonBounds.GetExtent().X / (Settings.RoomXExtent.Y);
+	const int32 YCells = DungeonBounds.GetExtent().Y / (Settings.RoomYExtent.Y);
+	const int32 ZCells = DungeonBounds.GetExtent().Z / (Settings.RoomZExtent.Y);
+	if(XCells <= 0 || YCells <= 0 || ZCells <= 0)
+	{
+		UE_LOG(LogDungeonGenerator, Warning, TEXT("Dungeon bounds %s can't fit a single room"), *DungeonBounds.ToString());
+		return;
+	}
+
+	FBox CellBounds(FVector::ZeroVector, FVector::ZeroVector);
+	CellBounds = CellBounds.ExpandBy(FVector(DungeonBounds.GetExtent().X / XCells,  DungeonBounds.GetExtent().Y / YCells, DungeonBounds.GetExtent().Z / ZCells));
+	const FVector CellStartingLocation = DungeonBounds.Min - CellBounds.Min;
+
+	const int32 CellCount = static_cast<int32>(FMath::Min<int64>(static_cast<int64>(XCells) * YCells * ZCells, MAX_int32));
+	const int32 RoomsToGenerate = RandomStream.RandRange(FMath::Min(Settings.MinRooms,CellCount) , FMath::Min(Settings.MaxRooms,CellCount));
+	TArray<FVector> UsedUpCells;
+	//Partial Fisher-Yates over the cell indices. Only swapped slots are stored so drawing a cell is O(1) whatever the grid size
+	TMap<int32, int32> SwappedCells;
+	if(Settings.RoomPlacementMethod == ERoomPlacementMethod::ShuffledCell)
+	{
+		SwappedCells.Reserve(RoomsToGenerate);
+	}
+	for(int32 i = 0; i < RoomsToGenerate; i++)
+	{
+		// Randomise the size of the room, and in what cell we want to spawn it.
+		// reduce the bounds of the cell by the size of the room, so we are sure the room won't go outside the spawn area.
+		// randomise a location in the narrowed down Cell bounds.
+		const FVector CellExtend = CellBounds.GetExtent()*2.0f;
+		const FVector RoomSize = RandomRoomExtent(RandomStream);
+
+		//Make sure we dont use a cell already with a room
+		FVector CellCoord = FVector::ZeroVector;
+		if(Settings.RoomPlacementMethod == ERoomPlacementMethod::ShuffledCell)
+		{
+			const int32 SwapIdx = RandomStream.RandRange(i, CellCount - 1);
+			const int32* SwapCell = SwappedCells.Find(SwapIdx);
+			const int32* CurrentCell = SwappedCells.Find(i);
+			const int32 CellIdx = SwapCell ? *SwapCell : SwapIdx;
+			SwappedCells.Add(SwapIdx, CurrentCell ? *CurrentCell : i);
+			CellCoord = FVector(CellIdx % XCells, (CellIdx / XCells) % YCells, CellIdx / (static_cast<int64>(XCells) * YCells));
+		}
+		else
+		{
+			do
+			{
+				const int32 XCell = RandomStream.RandRange(0, XCells - 1);
+				const int32 YCell = RandomStream.RandRange(0, YCells - 1);
+				const int32 ZCell = RandomStream.RandRange(0, ZCells - 1);
+				CellCoord = FVector(XCell, YCell, ZCell);
+
+			}while(UsedUpCells.Contains(CellCoord));
+
+			UsedUpCells.Add(CellCoord);
+		}
+
+		const float XPosition = CellCoord.X*CellExtend.X+CellStartingLocation.X;
+		const float YPosition = CellCoord.Y*CellExtend.Y+CellStartingLocation.Y;
+		const float ZPosition = CellCoord.Z*CellExtend.Z+CellStartingLocation.Z;
+
+		FBox SpawnerCellBounds = CellBounds.ExpandBy(-RoomSize);
+		SpawnerCellBounds = SpawnerCellBounds.MoveTo(FVector(XPosition, YPosition, ZPosition));
+
+		const FVector RoomLocation = RandomStream.RandPointInBox(SpawnerCellBounds);
+
+		FDungeonNode& NewRoom = DungeonNodes.AddDefaulted_GetRef();
+		NewRoom.Location = RoomLocation;
+		NewRoom.Extent = RoomSize;
+	}
+}
+
+void FDungeonLayout::PlaceRoomsPoissonDisk(const FRandomStream& RandomStream)
+{
+	//Bridson sampling with boxes instead of spheres. Two rooms are apart when, on some axis, their centers are further
+	//than their extents added up and scaled by Spacing. A hash cell is as big as the largest possible separation, so
+	//only the 27 cells around a candidate need to be checked
+	const FVector MaxRoomExtent(Settings.RoomXExtent.Y, Settings.RoomYExtent.Y, Settings.RoomZExtent.Y);
+	const FBox SpawnBounds = DungeonBounds.ExpandBy(-MaxRoomExtent);
+	if(MaxRoomExtent.GetMin() <= 0.0f || SpawnBounds.Min.X > SpawnBounds.Max.X || SpawnBounds.Min.Y > SpawnBounds.Max.Y || SpawnBounds.Min.Z > SpawnBounds.Max.Z)
+	{
+		UE_LOG(LogDungeonGenerator, Warning, TEXT("Dungeon bounds %s can't fit a single room"), *DungeonBounds.ToString());
+		return;
+	}
+
+	const int32 RoomsToGenerate = RandomStream.RandRange(Settings.MinRooms, Settings.MaxRooms);
+	if(RoomsToGenerate <= 0)
+	{
+		return;
+	}
+
+	//Spread the rooms so that the requested amount roughly fills the bounds instead of clumping around the first one
+	const double RoomCellVolume = (MaxRoomExtent * 2.0f).X * (MaxRoomExtent * 2.0f).Y * (MaxRoomExtent * 2.0f).Z;
+	const double Spacing = FMath::Max(1.0, FMath::Pow(DungeonBounds.GetVolume() / (RoomCellVolume * RoomsToGenerate), 1.0 / 3.0) * PoissonDiskDensity);
+	const FVector HashCellSize = MaxRoomExtent * 2.0f * Spacing;
+
+	//Spatial hash over the bounds, every bucket is a linked list of the rooms whose center falls in it
+	const FVector GridSize = DungeonBounds.GetSize() / HashCellSize;
+	const FIntVector GridCells(FMath::Max(1, FMath::CeilToInt(GridSize.X)), FMath::Max(1, FMath::CeilToInt(GridSize.Y)), FMath::Max(1, FMath::CeilToInt(GridSize.Z)));
+	TArray<int32> CellFirstRoom;
+	CellFirstRoom.Init(INDEX_NONE, GridCells.X * GridCells.Y * GridCells.Z);
+	TArray<int32> NextRoomInCell;
+	NextRoomInCell.Reserve(RoomsToGenerate);
+	auto GetHashCell = [this, &HashCellSize, &GridCells](const FVector& Location)
+	{
+		const FVector Cell = (Location - DungeonBounds.Min) / HashCellSize;
+		return FIntVector(FMath::Clamp(FMath::FloorToInt(Cell.X), 0, GridCells.X - 1), FMath::Clamp(FMath::FloorToInt(Cell.Y), 0, GridCells.Y - 1), FMath::Clamp(FMath::FloorToInt(Cell.Z), 0, GridCells.Z - 1));
+	};
+	auto GetCellIndex = [&GridCells](const FIntVector& Cell)
+	{
+		return (Cell.Z * GridCells.Y + Cell.Y) * GridCells.X + Cell.X;
+	};
+	auto CanPlaceRoom = [this, &CellFirstRoom, &NextRoomInCell, &GridCells, &GetHashCell, &GetCellIndex, Spacing](const FVector& Location, const FVector& Extent)
+	{
+		if(!DungeonBounds.ExpandBy(-Extent).IsInsideOrOn(Location))
+		{
+			return false;
+		}
+		const FIntVector Cell = GetHashCell(Location);
+		const FIntVector MinCell(FMath::Max(Cell.X - 1, 0), FMath::Max(Cell.Y - 1, 0), FMath::Max(Cell.Z - 1, 0));
+		const FIntVector MaxCell(FMath::Min(Cell.X + 1, GridCells.X - 1), FMath::Min(Cell.Y + 1, GridCells.Y - 1), FMath::Min(Cell.Z + 1, GridCells.Z - 1));
+		for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+				{
+					for (int32 RoomIdx = CellFirstRoom[GetCellIndex(FIntVector(X, Y, Z))]; RoomIdx != INDEX_NONE; RoomIdx = NextRoomInCell[RoomIdx])
+					{
+						const FDungeonNode& Room = DungeonNodes[RoomIdx];
+						const FVector Separation = (Room.Extent + Extent) * Spacing;
+						const FVector Distance = (Room.Location - Location).GetAbs();
+						if(Distance.X < Separation.X && Distance.Y < Separation.Y && Distance.Z < Separation.Z)
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+		return true;
+	};
+	auto AddRoom = [this, &CellFirstRoom, &NextRoomInCell, &GetHashCell, &GetCellIndex](const FVector& Location, const FVector& Extent)
+	{
+		const int32 RoomIdx = DungeonNodes.Num();
+		FDungeonNode& NewRoom = DungeonNodes.AddDefaulted_GetRef();
+		NewRoom.Location = Location;
+		NewRoom.Extent = Extent;
+		int32& FirstRoom = CellFirstRoom[GetCellIndex(GetHashCell(Location))];
+		NextRoomInCell.Add(FirstRoom);
+		FirstRoom = RoomIdx;
+		return RoomIdx;
+	};
+
+	TArray<int32> ActiveRooms;
+	ActiveRooms.Add(AddRoom(RandomStream.RandPointInBox(SpawnBounds), RandomRoomExtent(RandomStream)));
+	while (!ActiveRooms.IsEmpty() && DungeonNodes.Num() < RoomsToGenerate)
+	{
+		const int32 ActiveIdx = RandomStream.RandRange(0, ActiveRooms.Num() - 1);
+		const FDungeonNode ActiveRoom = DungeonNodes[ActiveRooms[ActiveIdx]];
+
+		bool bPlacedRoom = false;
+		for (int32 Attempt = 0; Attempt < PoissonDiskAttempts && !bPlacedRoom; ++Attempt)
+		{
+			//Random direction pushed out to the box around the active room, then between one and two separations away
+			const FVector RoomExtent = RandomRoomExtent(RandomStream);
+			const FVector Direction = RandomStream.GetUnitVector();
+			const FVector Offset = Direction / Direction.GetAbsMax() * (ActiveRoom.Extent + RoomExtent) * Spacing * RandomStream.FRandRange(1.0f, 2.0f);
+			const FVector Candidate = ActiveRoom.Location + Offset;
+			if(CanPlaceRoom(Candidate, RoomExtent))
+			{
+				ActiveRooms.Add(AddRoom(Candidate, RoomExtent));
+				bPlacedRoom = true;
+			}
+		}
+
+		if(!bPlacedRoom)
+		{
+			ActiveRooms.RemoveAtSwap(ActiveIdx);
+		}
+	}
+
+	if(DungeonNodes.Num() < Settings.MinRooms)
+	{
+		UE_LOG(LogDungeonGenerator, Warning, TEXT("Dungeon bounds %s only fit %d rooms"), *DungeonBounds.ToString(), DungeonNodes.Num());
+	}
+}
+
+void FDungeonLayout::ConnectRooms()
+{
+	SCOPE_DUNGEON_STAT(STAT_ConnectRooms);
+	TetrahedronCount = 0;
+	DungeonConnections.Empty();
+	DungeonHallways.Empty();
+	if(DungeonNodes.IsEmpty())
+	{
+		return;
+	}
+
+	RoomBVH.Build(DungeonNodes);
+
+	TArray<FVector> RoomLocations;
+	RoomLocations.Reserve(DungeonNodes.Num());
+	for (const FDungeonNode& Room : DungeonNodes)
+	{
+		RoomLocations.Add(Room.Location);
+	}
+
+	TArray<uint64> Edges;
+	const TUniquePtr<ITriangulationBackend> Triangulator = ITriangulationBackend::Create(Settings.TriangulationBackend, RoomLocations.Num(), Settings.ParallelTriangulationMinRooms);
+	TetrahedronCount = Triangulator->Triangulate(RoomLocations, Edges);
+	GenerateConnectionFromEdges(Edges);
+	SET_DWORD_STAT(STAT_TetrahedronCount, TetrahedronCount);
+	SET_DWORD_STAT(STAT_ConnectionCount, DungeonConnections.Num());
+}
+
+void FDungeonLayout::SimplifyConnections()
+{
+	if(DungeonNodes.IsEmpty())
+	{
+		return;
+	}
+	SCOPE_DUNGEON_STAT(STAT_SimplifyConections);
+	//To simplify the hallways generated by the Delauney algo we keep either the shortest paths from a fixed room to all
+	//other or a minimum spanning tree with some loops, and remove every other edge
+	int32 StartingRoom = DungeonNodes.IndexOfByPredicate([](const FDungeonNode& Room){ return Room.RoomType == ERoomType::Starting;});
+	FRandomStream RandomStream(Settings.RandomSeed);
+	if(StartingRoom == INDEX_NONE)
+	{
+		StartingRoom = RandomStream.RandRange(0, DungeonNodes.Num() - 1);
+		DungeonNodes[StartingRoom].RoomType = ERoomType::Starting;
+	}
+
+	//if you whant to keep some hallways even if they are not used in any path jus add the conditions below
+	//EG: Randomize when returning true to have a chance to not remove the hallway.
+	TArray<bool> UsedConnections;
+	if(Settings.ConnectionSimplificationMethod == EConnectionSimplificationMethod::MinimumSpanningTree)
+	{
+		SelectSpanningTreeConnections(RandomStream, UsedConnections);
+	}
+	else if(Settings.ConnectionSimplificationMethod == EConnectionSimplificationMethod::GreedySpanner)
+	{
+		SelectSpannerConnections(UsedConnections);
+	}
+	else
+	{
+		TArray<double> Distances;
+		TArray<int32> PathConnections;
+		TArray<int32> PathRooms;
+		FindShortestPaths(StartingRoom, Distances, PathConnections, PathRooms);
+		UsedConnections.Init(false, DungeonConnections.Num());
+		for (const int32 PathConnectionIdx : PathConnections)
+		{
+			if(PathConnectionIdx != INDEX_NONE)
+			{
+				UsedConnections[PathConnectionIdx] = true;
+			}
+		}
+	}
+
+	TArray<FDungeonConnection> UsedDungeonConnections;
+	UsedDungeonConnections.Reserve(DungeonConnections.Num());
+	for (int32 ConnectionIdx = 0; ConnectionIdx < DungeonConnections.Num(); ++ConnectionIdx)
+	{
+		if(UsedConnections[ConnectionIdx])
+		{
+			UsedDungeonConnections.Add(DungeonConnections[ConnectionIdx]);
+		}
+	}
+	DungeonConnections = MoveTemp(UsedDungeonConnections);
+	RoomGraph.Build(DungeonNodes.Num(), DungeonConnections);
+	SET_DWORD_STAT(STAT_ConnectionCount, DungeonConnections.Num());
+
+	//Marking the room at the end of the longest path as the boss room
+	TArray<double> Distances;
+	TArray<int32> PathConnections;
+	TArray<int32> PathRooms;
+	FindShortestPaths(StartingRoom, Distances, PathConnections, PathRooms);
+	int32 FurthestRoom = StartingRoom;
+	double FurthestDistance = 0.0;
+	for (int32 RoomIdx = 0; RoomIdx < DungeonNodes.Num(); ++RoomIdx)
+	{
+		if(PathConnections[RoomIdx] != INDEX_NONE && Distances[RoomIdx] > FurthestDistance)
+		{
+			FurthestDistance = Distances[RoomIdx];
+			FurthestRoom = RoomIdx;
+		}
+	}
+	DungeonNodes[FurthestRoom].RoomType = ERoomType::End;
+	CriticalPathLength = static_cast<float>(FurthestDistance);
+	CriticalPathRoomCount = PathRooms[FurthestRoom];
+}
+
+void FDungeonLayout::FindShortestPaths(int32 StartRoom, TArray<double>& OutDistances, TArray<int32>& OutPathConnections, TArray<int32>& OutPathRooms) const
+{
+	//One Dijkstra pass from the starting room gives the shortest path to every room as a tree of predecessors
+	OutDistances.Init(MAX_dbl, DungeonNodes.Num());
+	OutPathConnections.Init(INDEX_NONE, DungeonNodes.Num());
+	OutPathRooms.Init(0, DungeonNodes.Num());
+	TDungeonAStar<int32> Search;
+	Search.AddStart(StartRoom, 0.0, 0.0);
+	for (int32 NodeIdx = Search.PopOpen(); NodeIdx != INDEX_NONE; NodeIdx = Search.PopOpen())
+	{
+		const int32 CurrentRoom = Search.GetNode(NodeIdx).State;
+		const double CurrentDistance = Search.GetNode(NodeIdx).G;
+		OutDistances[CurrentRoom] = CurrentDistance;
+		OutPathRooms[CurrentRoom] = Search.GetNode(NodeIdx).Depth;
+
+		const TConstArrayView<int32> Neighbours = RoomGraph.GetNeighbours(CurrentRoom);
+		const TConstArrayView<int32> Connections = RoomGraph.GetConnections(CurrentRoom);
+		for (int32 NeighbourIdx = 0; NeighbourIdx < Neighbours.Num(); ++NeighbourIdx)
+		{
+			const int32 Room = Neighbours[NeighbourIdx];
+			const double Distance = CurrentDistance + FVector::Dist(DungeonNodes[CurrentRoom].Location, DungeonNodes[Room].Location);
+			if(Search.Relax(NodeIdx, Room, Distance, 0.0) != INDEX_NONE)
+			{
+				OutPathConnections[Room] = Connections[NeighbourIdx];
+			}
+		}
+	}
+}
+
+void FDungeonLayout::SelectSpanningTreeConnections(const FRandomStream& RandomStream, TArray<bool>& OutUsedConnections) const
+{
+	//Kruskal, shortest connections first
+	TArray<double> Lengths;
+	TArray<int32> SortedConnections;
+	SortConnectionsByLength(Lengths, SortedConnections);
+
+	//Union find with path halving and union by size
+	TArray<int32> Parents;
+	TArray<int32> Sizes;
+	Parents.SetNumUninitialized(DungeonNodes.Num());
+	Sizes.Init(1, DungeonNodes.Num());
+	for (int32 RoomIdx = 0; RoomIdx < DungeonNodes.Num(); ++RoomIdx)
+	{
+		Parents[RoomIdx] = RoomIdx;
+	}
+	auto FindRoot = [&Parents](int32 Room)
+	{
+		while (Parents[Room] != Room)
+		{
+			Parents[Room] = Parents[Parents[Room]];
+			Room = Parents[Room];
+		}
+		return Room;
+	};
+
+	OutUsedConnections.Init(false, DungeonConnections.Num());
+	TArray<int32> LoopConnections;
+	for (const int32 ConnectionIdx : SortedConnections)
+	{
+		int32 StartRoot = FindRoot(DungeonConnections[ConnectionIdx].StartRoom);
+		int32 EndRoot = FindRoot(DungeonConnections[ConnectionIdx].EndRoom);
+		if(StartRoot == EndRoot)
+		{
+			LoopConnections.Add(ConnectionIdx);
+			continue;
+		}
+		if(Sizes[StartRoot] < Sizes[EndRoot])
+		{
+			Swap(StartRoot, EndRoot);
+		}
+		Parents[EndRoot] = StartRoot;
+		Sizes[StartRoot] += Sizes[EndRoot];
+		OutUsedConnections[ConnectionIdx] = true;
+	}
+
+	//Seeded pick of the connections left out, each one closes a loop
+	const int32 NumExtraConnections = FMath::RoundToInt(FMath::Clamp(Settings.ExtraConnectionRatio, 0.0f, 1.0f) * LoopConnections.Num());
+	for (int32 ExtraIdx = 0; ExtraIdx < NumExtraConnections; ++ExtraIdx)
+	{
+		const int32 PickIdx = RandomStream.RandRange(ExtraIdx, LoopConnections.Num() - 1);
+		LoopConnections.Swap(ExtraIdx, PickIdx);
+		OutUsedConnections[LoopConnections[ExtraIdx]] = true;
+	}
+}
+
+void FDungeonLayout::SortConnectionsByLength(TArray<double>& OutLengths, TArray<int32>& OutSortedConnections) const
+{
+	OutLengths.SetNumUninitialized(DungeonConnections.Num());
+	OutSortedConnections.SetNumUninitialized(DungeonConnections.Num());
+	for (int32 ConnectionIdx = 0; ConnectionIdx < DungeonConnections.Num(); ++ConnectionIdx)
+	{
+		const FDungeonConnection& Connection = DungeonConnections[ConnectionIdx];
+		OutLengths[ConnectionIdx] = FVector::Dist(DungeonNodes[Connection.StartRoom].Location, DungeonNodes[Connection.EndRoom].Location);
+		OutSortedConnections[ConnectionIdx] = ConnectionIdx;
+	}
+	//The index breaks ties so the order only depends on the layout
+	OutSortedConnections.Sort([&OutLengths](int32 A, int32 B)
+	{
+		return OutLengths[A] < OutLengths[B] || (OutLengths[A] == OutLengths[B] && A < B);
+	});
+}
+
+void FDungeonLayout::SelectSpannerConnections(TArray<bool>& OutUsedConnections) const
+{
+	const double Stretch = FMath::Max(static_cast<double>(Settings.SpannerStretch), 1.0);
+	TArray<double> Lengths;
+	TArray<int32> SortedConnections;
+	SortConnectionsByLength(Lengths, SortedConnections);
+
+	//Greedy spanner: going from the shortest connection up, one is kept only if the kept ones can't already join its
+	//rooms within Stretch times its length. Every search is cut at that length, so it only explores a small neighbourhood
+	TArray<TArray<TPair<int32, double>, TInlineAllocator<8>>> SpannerNeighbours;
+	SpannerNeighbours.SetNum(DungeonNodes.Num());
+	TDungeonAStar<int32> Search;
+	OutUsedConnections.Init(false, DungeonConnections.Num());
+	for (const int32 ConnectionIdx : SortedConnections)
+	{
+		const FDungeonConnection& Connection = DungeonConnections[ConnectionIdx];
+		const double MaxDistance = Stretch * Lengths[ConnectionIdx];
+
+		bool bIsReachable = false;
+		Search.Reset();
+		Search.AddStart(Connection.StartRoom, 0.0, 0.0);
+		for (int32 NodeIdx = Search.PopOpen(); NodeIdx != INDEX_NONE; NodeIdx = Search.PopOpen())
+		{
+			const int32 CurrentRoom = Search.GetNode(NodeIdx).State;
+			if(CurrentRoom == Connection.EndRoom)
+			{
+				bIsReachable = true;
+				break;
+			}
+			const double CurrentDistance = Search.GetNode(NodeIdx).G;
+			for (const TPair<int32, double>& Neighbour : SpannerNeighbours[CurrentRoom])
+			{
+				const double Distance = CurrentDistance + Neighbour.Value;
+				if(Distance <= MaxDistance)
+				{
+					Search.Relax(NodeIdx, Neighbour.Key, Distance, 0.0);
+				}
+			}
+		}
+
+		if(!bIsReachable)
+		{
+			OutUsedConnections[ConnectionIdx] = true;
+			SpannerNeighbours[Connection.StartRoom].Add(TPair<int32, double>(Connection.EndRoom, Lengths[ConnectionIdx]));
+			SpannerNeighbours[Connection.EndRoom].Add(TPair<int32, double>(Connection.StartRoom, Lengths[ConnectionIdx]));
+		}
+	}
+}
+
+void FDungeonLayout::Collapse()
+{
+	BeginCollapse();
+	for (int32 Iteration = 0; Iteration < Settings.MaxCollapseIterations; ++Iteration)
+	{
+		if(!StepCollapse(Settings.CollapseTimeStep))
+		{
+			break;
+		}
+	}
+	bIsCollapsing = false;
+}
+
+void FDungeonLayout::BeginCollapse()
+{
+	bIsCollapsing = true;
+	CollapsingIterationNotModified = 0;
+}
+
+bool FDungeonLayout::StepCollapse(float DeltaSeconds)
+{
+	SCOPE_DUNGEON_STAT(STAT_Collapse);
+	if(!bIsCollapsing || DungeonNodes.IsEmpty())
+	{
+		bIsCollapsing = false;
+		return false;
+	}
+
+	bIsCollapsing = false;
+	for (int i = 0; i < DungeonNodes.Num(); ++i)
+	{
+		FDungeonNode& FirstNode = DungeonNodes[i];
+		FSphere FirstNodeSphere(FirstNode.Location, FirstNode.Extent.Size() + Settings.HallWaySectionDimensions.X);
+		FVector Force = FVector::ZeroVector;
+		if(FirstNode.RoomType == ERoomType::Starting || FirstNode.RoomType == ERoomType::End)
+		{
+			continue;
+		}
+
+		if(Settings.bApplyNodeRepulsion)
+		{
+			for (int j = 0; j < DungeonNodes.Num(); ++j)
+			{
+				if(i == j)
+				{
+					continue;
+				}
+				const FDungeonNode& SecondNode = DungeonNodes[j];
+				FSphere SecondNodeSphere(SecondNode.Location, SecondNode.Extent.Size() + Settings.HallWaySectionDimensions.X);
+				FVector InteractionDirection = FirstNode.Location - SecondNode.Location;
+				const float NodeSeparation = InteractionDirection.Size();
+				const float Distance = NodeSeparation - (FirstNodeSphere.W + SecondNodeSphere.W);
+				constexpr float G = 6.6743E-11;
+				const float FirstSphereVolume = FirstNodeSphere.GetVolume();
+				const float SecondSphereVolume = SecondNodeSphere.GetVolume();
+				const float RepulsionMagnitude = G * (FirstSphereVolume)  * (SecondSphereVolume) / (Distance * Distance);
+				Force += InteractionDirection.GetSafeNormal() * RepulsionMagnitude;
+			}
+		}
+
+		//Hooks Law Fspring = -K*X
+		// X = current length - resting length
+		// K = spring Constant
+		if(Settings.bApplySpringForce)
+		{
+			for (const int32 NeighbourIdx : RoomGraph.GetNeighbours(i))
+			{
+				const FDungeonNode& SecondNode = DungeonNodes[NeighbourIdx];
+				const FSphere SecondNodeSphere(SecondNode.Location, SecondNode.Extent.Size());
+
+				FVector Spring = FirstNodeSphere.Center - SecondNodeSphere.Center;
+				const float RestingDistance = FirstNodeSphere.W + SecondNodeSphere.W;
+				const float SpringSize = Spring.Size();
+				const float X = SpringSize - RestingDistance;
+				const FVector SpringForce = -Settings.SpringConstant * X * Spring.GetSafeNormal();
+				Force += SpringForce;
+			}
+		}
+		FirstNode.Velocity += Force;
+	}
+
+	FVector MinDungeonBounds = DungeonNodes[0].Location - DungeonNodes[0].Extent;
+	FVector MaxDungeonBounds = DungeonNodes[0].Location + DungeonNodes[0].Extent;
+	bool IsStaticIteration = true;
+	for (FDungeonNode& Node : DungeonNodes)
+	{
+		Node.PrevLocation = Node.Location;
+		Node.Location += Node.Velocity*DeltaSeconds;
+		Node.Velocity *= Settings.SpringForcePreservation;
+
+		FVector RoomMin = Node.Location - Node.Extent;
+		FVector RoomMax = Node.Location + Node.Extent;
+
+		MinDungeonBounds.X = FMath::Min(RoomMin.X, MinDungeonBounds.X);
+		MinDungeonBounds.Y = FMath::Min(RoomMin.Y, MinDungeonBounds.Y);
+		MinDungeonBounds.Z = FMath::Min(RoomMin.Z, MinDungeonBounds.Z);
+
+		MaxDungeonBounds.X = FMath::Max(RoomMax.X, MaxDungeonBounds.X);
+		MaxDungeonBounds.Y = FMath::Max(RoomMax.Y, MaxDungeonBounds.Y);
+		MaxDungeonBounds.Z = FMath::Max(RoomMax.Z, MaxDungeonBounds.Z);
+
+		const FBox ClampBounds = Settings.Bounds.ExpandBy(-Node.Extent);
+		Node.Location = ClampBounds.GetClosestPointTo(Node.Location);
+		if(!Node.Location.Equals(Node.PrevLocation))
+		{
+			IsStaticIteration = false;
+		}
+		if(!Node.Velocity.IsNearlyZero(0.0001))
+		{
+			bIsCollapsing = true;
+		}
+	}
+	DungeonBounds = FBox(MinDungeonBounds, MaxDungeonBounds);
+	RoomBVH.Refit(DungeonNodes);
+	if(IsStaticIteration)
+	{
+		CollapsingIterationNotModified++;
+	}
+	if(CollapsingIterationNotModified >= 10/*MaxStaticIterations*/)
+	{
+		bIsCollapsing = false;
+	}
+	return bIsCollapsing;
+}
+
+void FDungeonLayout::CreateHallways()
+{
+	if(Settings.HallWayGenerationMethod != EHallwayGenerationMethod::PathFinding)
+	{
+		BeginHallwaysCreation();
+		return;
+	}
+
+	SCOPE_DUNGEON_STAT(STAT_CreateHallways);
+	DungeonHallways.Empty();
+	bIsCreatingHallways = false;
+	ConnectionID = 0;
+	SET_DWORD_STAT(STAT_PathFinderOpenNodes, 0);
+	SET_DWORD_STAT(STAT_PathFinderClosedNodes, 0);
+	if(DungeonConnections.IsEmpty())
+	{
+		return;
+	}
+
+	BuildOccupancy();
+
+	//Searches don't depend on each other. Longest connections take the longest, so they are handed out first and the
+	//short ones fill the gaps at the end
+	TArray<int32> SearchOrder;
+	SearchOrder.Reserve(DungeonConnections.Num());
+	TArray<double> SearchLengths;
+	SearchLengths.Reserve(DungeonConnections.Num());
+	for (int32 ConnectionIdx = 0; ConnectionIdx < DungeonConnections.Num(); ++ConnectionIdx)
+	{
+		const FDungeonConnection& Connection = DungeonConnections[ConnectionIdx];
+		SearchOrder.Add(ConnectionIdx);
+		SearchLengths.Add(FVector::DistSquared(DungeonNodes[Connection.StartRoom].Location, DungeonNodes[Connection.EndRoom].Location));
+	}
+	SearchOrder.Sort([&SearchLengths](int32 A, int32 B)
+	{
+		return SearchLengths[A] > SearchLengths[B] || (SearchLengths[A] == SearchLengths[B] && A < B);
+	});
+
+	//Hallways of earlier connections are only known once those are committed, so the jobs search without them
+	TArray<TArray<FVector>> HallwayPaths;
+	HallwayPaths.SetNum(DungeonConnections.Num());
+	TArray<TArray<FVector>> PathLocations;
+	PathLocations.SetNum(DungeonConnections.Num());
+	ParallelFor(SearchOrder.Num(), [&](int32 OrderIdx)
+	{
+		const int32 ConnectionIdx = SearchOrder[OrderIdx];
+		FindHallwayPath(ConnectionIdx, nullptr, false, HallwayPaths[ConnectionIdx], Settings.bPreventCrossing ? &PathLocations[ConnectionIdx] : nullptr);
+	}, EParallelForFlags::Unbalanced);
+
+	//Committed in connection order, so the hallways don't depend on which job finished first. A path clear of the earlier
+	//hallways is the one the search around them finds too, the others are searched again like StepHallwaysCreation does
+	for (int32 ConnectionIdx = 0; ConnectionIdx < DungeonConnections.Num(); ++ConnectionIdx)
+	{
+		if(Settings.bPreventCrossing && (HallwayPaths[ConnectionIdx].IsEmpty() || IsPathOverlappingHallways(DungeonConnections[ConnectionIdx], PathLocations[ConnectionIdx])))
+		{
+			HallwayPaths[ConnectionIdx].Reset();
+			FindHallwayPathAroundHallways(ConnectionIdx, HallwayPaths[ConnectionIdx]);
+		}
+		if(HallwayPaths[ConnectionIdx].IsEmpty())
+		{
+			CreateFallbackHallways(ConnectionIdx);
+			continue;
+		}
+		CreateHallwaysFromPath(HallwayPaths[ConnectionIdx]);
+	}
+	ConnectionID = DungeonConnections.Num();
+	FinishHallways();
+}
+
+void FDungeonLayout::BeginHallwaysCreation()
+{
+	SCOPE_DUNGEON_STAT(STAT_CreateHallways);
+	DungeonHallways.Empty();
+	bIsCreatingHallways = false;
+	ConnectionID = 0;
+	SET_DWORD_STAT(STAT_PathFinderOpenNodes, 0);
+	SET_DWORD_STAT(STAT_PathFinderClosedNodes, 0);
+	if(DungeonConnections.IsEmpty())
+	{
+		return;
+	}
+
+	if(Settings.HallWayGenerationMethod == EHallwayGenerationMethod::PathFinding)
+	{
+		BuildOccupancy();
+		InitializePathFinder(HallwayPathFinder, DungeonConnections[ConnectionID], &HallwayOccupancy);
+		PathFinderIterations = 0;
+		bIsCreatingHallways = true;
+		return;
+	}
+
+	//creating hallways based on room connections
+	for (const FDungeonConnection& Connection : DungeonConnections)
+	{
+		CreateBasicHallways(Connection);
+	}
+	FinishHallways();
+}
+
+bool FDungeonLayout::StepHallwaysCreation(double TimeBudgetSeconds)
+{
+	SCOPE_DUNGEON_STAT(STAT_CreateHallways);
+	if(!bIsCreatingHallways)
+	{
+		return true;
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + TimeBudgetSeconds;
+	do
+	{
+		if(!DungeonConnections.IsValidIndex(ConnectionID))
+		{
+			bIsCreatingHallways = false;
+			return true;
+		}
+
+		const int32 RemainingIterations = Settings.MaxPathFinderIterations - PathFinderIterations;
+		const bool bGaveUp = RemainingIterations <= 0;
+		bool bIsSearchOver = bGaveUp;
+		if(bGaveUp)
+		{
+			UE_LOG(LogDungeonGenerator, Warning, TEXT("Hallway path finding gave up on connection %d after %d iterations"), ConnectionID, Settings.MaxPathFinderIterations);
+		}
+		else
+		{
+			SCOPE_DUNGEON_STAT(STAT_PathFinderEvaluate);
+			SetPathFinderOccupancy(HallwayPathFinder, &HallwayOccupancy);
+			int32 Expansions = 0;
+			bIsSearchOver = HallwayPathFinder.Evaluate(TimeBudgetSeconds > 0.0 ? RemainingIterations : 1, EndTime, Expansions);
+			PathFinderIterations += Expansions;
+		}
+
+		if(bIsSearchOver)
+		{
+			HallwayPathFinder.AccumulateStats();
+			const bool bFoundPath = !bGaveUp && !HallwayPathFinder.PathResult.IsEmpty();
+			if(!bFoundPath && Settings.bPreventCrossing && HallwayPathFinder.bBlockHallways)
+			{
+				//Walled in by hallways, they are let through at a cost
+				InitializePathFinder(HallwayPathFinder, DungeonConnections[ConnectionID], &HallwayOccupancy, false);
+				PathFinderIterations = 0;
+				continue;
+			}
+			if(bFoundPath)
+			{
+				CreateHallwaysFromPath(HallwayPathFinder.PathResult);
+			}
+			else
+			{
+				CreateFallbackHallways(ConnectionID);
+			}
+			ConnectionID++;
+			if(!DungeonConnections.IsValidIndex(ConnectionID))
+			{
+				FinishHallways();
+				bIsCreatingHallways = false;
+				return true;
+			}
+			InitializePathFinder(HallwayPathFinder, DungeonConnections[ConnectionID], &HallwayOccupancy);
+			PathFinderIterations = 0;
+		}
+	}
+	while (FPlatformTime::Seconds() < EndTime);
+	return false;
+}
+
+float FDungeonLayout::GetHallwaysCreationProgress() const
+{
+	if(!bIsCreatingHallways || DungeonConnections.IsEmpty())
+	{
+		return 1.0f;
+	}
+	return static_cast<float>(ConnectionID) / DungeonConnections.Num();
+}
+
+void FDungeonLayout::GenerateConnectionFromEdges(TConstArrayView<uint64> Edges)
+{
+	DungeonConnections.Empty(Edges.Num());
+	DungeonHallways.Empty();
+
+	//we try to create a hallway from each tetrahedron edge, in the edge order so both triangulators give the same list
+	for (const uint64 Edge : Edges)
+	{
+		const int32 StartVert = static_cast<int32>(Edge >> 32);
+		const int32 EndVert = static_cast<int32>(Edge & MAX_uint32);
+		TryCreateConnection(StartVert, EndVert);
+	}
+
+	RoomGraph.Build(DungeonNodes.Num(), DungeonConnections);
+}
+
+void FDungeonLayout::TryCreateConnection(int32 StartRoomIdx, int32 EndRoomIdx)
+{
+	const FDungeonNode& StartRoom = DungeonNodes[StartRoomIdx];
+	const FDungeonNode& EndRoom = DungeonNodes[EndRoomIdx];
+	//invalid if edge is connected to any of the dummy vertex created for the super tetrahedron
+	if(StartRoom.RoomType == ERoomType::Dummy || EndRoom.RoomType == ERoomType::Dummy)
+	{
+		return;
+	}
+
+	const FVector StartPoint = StartRoom.Location;
+	const FVector EndPoint = EndRoom.Location;
+	const FVector Direction = EndPoint - StartPoint;
+
+	//Swept with the hallway section, so the hallway doesn't clip the corner of a room the edge only passes by
+	const FVector HallwayHalfExtent = GetHallwayHalfExtent();
+	TArray<int32> CrossedRooms;
+	RoomBVH.QuerySegment(StartPoint, EndPoint, HallwayHalfExtent, CrossedRooms);
+	for (const int32 RoomIdx : CrossedRooms)
+	{
+		if(RoomIdx == StartRoomIdx || RoomIdx == EndRoomIdx)
+		{
+			continue;
+		}
+
+		//invalid if edge would cross another room
+		const bool Intersect = FMath::LineBoxIntersection(DungeonNodes[RoomIdx].GetBounds().ExpandBy(HallwayHalfExtent), StartPoint, EndPoint, Direction, Direction.Reciprocal());
+		if(Intersect)
+		{
+			return;
+		}
+	}
+	//Edges come in unique, so the connection can't be there already
+	DungeonConnections.Add(FDungeonConnection(StartRoomIdx, EndRoomIdx));
+}
+
+void FDungeonLayout::CreateBasicHallways(const FDungeonConnection& Connection)
+{
+	const TArray<FVector>& CoreValidConnectionDirection = HallwayPathFinder.CoreValidConnectionDirection;
+	FDungeonNode& StartRoom = DungeonNodes[Connection.StartRoom];
+	FDungeonNode& EndRoom = DungeonNodes[Connection.EndRoom];
+
+	///Divide conection into segments based on vector components///
+	const FVector ConnectionStart = StartRoom.Location;
+	const FVector ConnectionEnd = EndRoom.Location;
+	FVector ConnectionComponents[4];
+	ConnectionComponents[0] = ConnectionStart;
+	ConnectionComponents[3] = ConnectionEnd;
+
+	{
+		float ShortestDistanceToEndConnection = MAX_FLT;
+		for (int i = 0; i < 4; ++i)
+		{
+			FVector ExitPoint = ConnectionStart + CoreValidConnectionDirection[i] * (StartRoom.Extent);
+			float DistanceToEndConnection = FVector::DistSquared(ExitPoint, ConnectionEnd);
+
+			if(DistanceToEndConnection < ShortestDistanceToEndConnection)
+			{
+				ShortestDistanceToEndConnection = DistanceToEndConnection;
+				ConnectionComponents[1] = CoreValidConnectionDirection[i];
+			}
+		}
+	}
+
+	ConnectionComponents[0] = ConnectionStart + ConnectionComponents[1] * (StartRoom.Extent);
+
+	{
+		float ShortestDistanceToEndConnection = MAX_FLT;
+		for (int i = 0; i < 4; ++i)
+		{
+			FVector EExitPoint = ConnectionEnd + CoreValidConnectionDirection[i] * (EndRoom.Extent);
+			FVector StartToEnd = EExitPoint - ConnectionComponents[0];
+			FVector SHallwaySegment = ConnectionComponents[0] + ConnectionComponents[1] *  StartToEnd * 0.5f;
+			FPlane Plane(ConnectionComponents[1],ConnectionComponents[0] + SHallwaySegment);
+			FVector InterectionPoint;
+			bool Interect = FMath::SegmentPlaneIntersection(EExitPoint, EExitPoint + CoreValidConnectionDirection[i] * (EndRoom.Extent), Plane, InterectionPoint);
+			if(Interect)
+			{
+				continue;
+			}
+			FVector ExitPoint = ConnectionEnd + CoreValidConnectionDirection[i] * (EndRoom.Extent);
+			float DistanceToEndConnection = FVector::DistSquared(ExitPoint, ConnectionComponents[0]);
+			if(DistanceToEndConnection < ShortestDistanceToEndConnection)
+			{
+				ShortestDistanceToEndConnection = DistanceToEndConnection;
+				ConnectionComponents[2] = CoreValidConnectionDirection[i];
+			}
+		}
+	}
+
+	ConnectionComponents[3] = ConnectionEnd + ConnectionComponents[2] * (EndRoom.Extent);
+
+	FVector StartToEnd = ConnectionComponents[3] - ConnectionComponents[0];
+	ConnectionComponents[1] = ConnectionComponents[0] + ConnectionComponents[1] *  StartToEnd.GetAbs() * 0.5f;
+	ConnectionComponents[2] = ConnectionComponents[3] + ConnectionComponents[2] *  StartToEnd.GetAbs() * 0.5f;
+
+	const FVector Slope = ConnectionComponents[2] - ConnectionComponents[1];
+	const FVector SlopeDirection = Slope.GetSafeNormal();
+	FVector SlopeBase = Slope;
+	SlopeBase.Z = 0.f;
+	SlopeBase.Normalize();
+	float Dot = FVector::DotProduct(SlopeDirection, SlopeBase);
+	float SlopeAngle = FMath::RadiansToDegrees(FMath::Acos(Dot));
+	if(SlopeAngle > Settings.MaxHallwaySlope)
+	{
+		float TanAngl = FMath::Tan(FMath::DegreesToRadians(Settings.MaxHallwaySlope));
+		float Adjacent = Slope.Z/TanAngl;
+		Adjacent*=0.5f;
+		FVector Direction = ConnectionComponents[3] -  ConnectionComponents[2];
+		ConnectionComponents[2] = ConnectionComponents[3] - Direction.GetSafeNormal()*(Direction.Length() - Adjacent);
+		Direction = ConnectionComponents[1] -  ConnectionComponents[0];
+		ConnectionComponents[1] = ConnectionComponents[0] + Direction.GetSafeNormal()*(Direction.Length() - Adjacent);
+	}
+	/////////////////////////////////////////////////////////////
+
+	///Create the doors info for the hallway, and the star and end connector to the respective rooms ////
+	FDungeonHallwaySegment NewHallwayConnection;
+	if(CreateConnectionFromEdgePoint(StartRoom, ConnectionComponents[0], ConnectionComponents[1], NewHallwayConnection))
+	{
+		DungeonHallways.Add(NewHallwayConnection);
+	}
+	if(CreateConnectionFromEdgePoint(EndRoom, ConnectionComponents[3], ConnectionComponents[2], NewHallwayConnection))
+	{
+		DungeonHallways.Add(NewHallwayConnection);
+	}
+	////////////////////////////////////////////////////////////
+
+	/// create the hallway data from the conneciton components
+	for (int i = 0; i < 3; ++i)
+	{
+		if(ConnectionComponents[i].Equals(ConnectionComponents[i + 1]))
+		{
+			continue;
+		}
+
+		const bool IsStairs = (ConnectionComponents[i + 1].Z - ConnectionComponents[i].Z) != 0;
+		DungeonHallways.Add(FDungeonHallwaySegment(ConnectionComponents[i], ConnectionComponents[i + 1], IsStairs ? ECorridorType::Stairs : ECorridorType::HStraight));
+	}
+	////////////////////////////////////////////////////////////
+}
+
+void FDungeonLayout::CreateFallbackHallways(int32 ConnectionIdx)
+{
+	UE_LOG(LogDungeonGenerator, Warning, TEXT("No hallway path found for connection %d, falling back to a basic hallway"), ConnectionIdx);
+	const int32 FirstHallwayIdx = DungeonHallways.Num();
+	CreateBasicHallways(DungeonConnections[ConnectionIdx]);
+	if(!Settings.bPreventCrossing)
+	{
+		return;
+	}
+
+	SplitHallwaysCrossingRooms(FirstHallwayIdx);
+	const FVector HallwayHalfExtent = GetHallwayHalfExtent();
+	for (int32 HallwayIdx = FirstHallwayIdx; HallwayIdx < DungeonHallways.Num(); ++HallwayIdx)
+	{
+		HallwayOccupancy.AddSegment(DungeonHallways[HallwayIdx].Start, DungeonHallways[HallwayIdx].End, HallwayHalfExtent);
+	}
+}
+
+void FDungeonLayout::BuildOccupancy()
+{
+	const FVector VoxelSize(Settings.HallWaySectionDimensions.X * 0.5f, Settings.HallWaySectionDimensions.X * 0.5f, Settings.HallWaySectionDimensions.Y * 0.5f);
+	RoomOccupancy.Reset(VoxelSize);
+	HallwayOccupancy.Reset(VoxelSize);
+	if(!Settings.bPreventCrossing)
+	{
+		return;
+	}
+	const FVector Margin = GetRoomObstacleMargin();
+	for (const FDungeonNode& Room : DungeonNodes)
+	{
+		RoomOccupancy.AddBox(Room.GetBounds().ExpandBy(Margin));
+	}
+}
+
+FVector FDungeonLayout::GetRoomObstacleMargin() const
+{
+	//A whole segment sideways, so paths cutting corners between path nodes still keep clear of the room
+	return FVector(Settings.HallWaySectionDimensions.X, Settings.HallWaySectionDimensions.X, Settings.HallWaySectionDimensions.Y * 0.5f);
+}
+
+FVector FDungeonLayout::GetHallwayHalfExtent() const
+{
+	return FVector(Settings.HallWaySectionDimensions.X * 0.5f, Settings.HallWaySectionDimensions.X * 0.5f, Settings.HallWaySectionDimensions.Y * 0.5f);
+}
+
+void FDungeonLayout::InitializePathFinder(FDungeonHallwayPathFinder& PathFinder, const FDungeonConnection& Connection, const FDungeonOccupancyGrid* AvoidedHallways, bool bBlockHallways) const
+{
+	const FDungeonNode& StartRoom = DungeonNodes[Connection.StartRoom];
+	const FDungeonNode& EndRoom = DungeonNodes[Connection.EndRoom];
+	PathFinder.MaxSlopeAngle = Settings.MaxHallwaySlope;
+	PathFinder.HallWaySegmentLength = Settings.HallWaySectionDimensions.X;
+	PathFinder.PathStartLocation = StartRoom.Location;
+	PathFinder.StartRoomExtent = StartRoom.Extent;
+	PathFinder.EndRoomExtent = EndRoom.Extent;
+	PathFinder.RoomObstacleMargin = GetRoomObstacleMargin();
+	SetPathFinderOccupancy(PathFinder, AvoidedHallways);
+	PathFinder.bBlockHallways = bBlockHallways;
+	PathFinder.FillAdditionalValidConnectionDirections(StartRoom.Location, EndRoom.Location);
+	PathFinder.Initialize(StartRoom.Location, EndRoom.Location);
+}
+
+void FDungeonLayout::SetPathFinderOccupancy(FDungeonHallwayPathFinder& PathFinder, const FDungeonOccupancyGrid* AvoidedHallways) const
+{
+	PathFinder.RoomOccupancy = Settings.bPreventCrossing ? &RoomOccupancy : nullptr;
+	PathFinder.HallwayOccupancy = Settings.bPreventCrossing ? AvoidedHallways : nullptr;
+}
+
+void FDungeonLayout::FindHallwayPath(int32 ConnectionIdx, const FDungeonOccupancyGrid* AvoidedHallways, bool bBlockHallways, TArray<FVector>& OutPath, TArray<FVector>* OutPathLocations) const
+{
+	SCOPE_DUNGEON_STAT(STAT_PathFinderEvaluate);
+	FDungeonHallwayPathFinder PathFinder;
+	InitializePathFinder(PathFinder, DungeonConnections[ConnectionIdx], AvoidedHallways, bBlockHallways);
+	bool bIsSearchOver = false;
+	for (int32 Iteration = 0; Iteration < Settings.MaxPathFinderIterations && !bIsSearchOver; ++Iteration)
+	{
+		bIsSearchOver = PathFinder.Evaluate();
+	}
+	PathFinder.AccumulateStats();
+	if(!bIsSearchOver)
+	{
+		UE_LOG(LogDungeonGenerator, Warning, TEXT("Hallway path finding gave up on connection %d after %d iterations"), ConnectionIdx, Settings.MaxPathFinderIterations);
+		return;
+	}
+	OutPath = MoveTemp(PathFinder.PathResult);
+	if(OutPathLocations && !OutPath.IsEmpty())
+	{
+		PathFinder.GetCurrentPathLocations(*OutPathLocations);
+	}
+}
+
+void FDungeonLayout::FindHallwayPathAroundHallways(int32 ConnectionIdx, TArray<FVector>& OutPath) const
+{
+	FindHallwayPath(ConnectionIdx, &HallwayOccupancy, true, OutPath);
+	if(OutPath.IsEmpty())
+	{
+		//Walled in by hallways, they are let through at a cost
+		FindHallwayPath(ConnectionIdx, &HallwayOccupancy, false, OutPath);
+	}
+}
+
+bool FDungeonLayout::IsPathOverlappingHallways(const FDungeonConnection& Connection, const TArray<FVector>& PathLocations) const
+{
+	const float SegmentLength = Settings.HallWaySectionDimensions.X;
+	const FDungeonNode& StartRoom = DungeonNodes[Connection.StartRoom];
+	const FDungeonNode& EndRoom = DungeonNodes[Connection.EndRoom];
+	const FBox StartArea = FDungeonHallwayPathFinder::GetConnectedRoomArea(StartRoom.Location, StartRoom.Extent, SegmentLength);
+	const FBox EndArea = FDungeonHallwayPathFinder::GetConnectedRoomArea(EndRoom.Location, EndRoom.Extent, SegmentLength);
+	auto IsInOtherHallway = [this, &StartArea, &EndArea](const FVector& Location)
+	{
+		return HallwayOccupancy.IsOccupied(Location) && !StartArea.IsInsideOrOn(Location) && !EndArea.IsInsideOrOn(Location);
+	};
+	for (int32 LocationIdx = 0; LocationIdx < PathLocations.Num(); ++LocationIdx)
+	{
+		if(IsInOtherHallway(PathLocations[LocationIdx]))
+		{
+			return true;
+		}
+		if(LocationIdx > 0 && IsInOtherHallway((PathLocations[LocationIdx - 1] + PathLocations[LocationIdx]) * 0.5))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FDungeonLayout::CreateHallwaysFromPath(const TArray<FVector>& Path)
+{
+	SCOPE_DUNGEON_STAT(STAT_CreateHallwaysFromPath);
+	const FVector HallwayHalfExtent = GetHallwayHalfExtent();
+	for (int i = 0; i <Path.Num() - 1; ++i)
+	{
+		const bool IsStairs = (Path[i + 1].Z - Path[i].Z) != 0;
+		DungeonHallways.Add(FDungeonHallwaySegment(Path[i], Path[i + 1], IsStairs ? ECorridorType::Stairs : ECorridorType::HStraight));
+		if(Settings.bPreventCrossing)
+		{
+			HallwayOccupancy.AddSegment(Path[i], Path[i + 1], HallwayHalfExtent);
+		}
+	}
+}
+
+void FDungeonLayout::FinishHallways()
+{
+	SCOPE_DUNGEON_STAT(STAT_FinishHallways);
+	// some hallways might go through dungeon rooms, so we should split them to prevent this. Path found ones are routed
+	// around the rooms already, and their basic fallbacks are split as they are created
+	if(Settings.bPreventCrossing && Settings.HallWayGenerationMethod != EHallwayGenerationMethod::PathFinding)
+	{
+		SplitHallwaysCrossingRooms(0);
+	}
+
+	//Merge Hallways that fallow the same path
+	int32 NumHallways = DungeonHallways.Num();
+	for (int i = 0; i < NumHallways; ++i)
+	{
+		FDungeonHallwaySegment& FirstHallway = DungeonHallways[i];
+		if(FirstHallway.Type != ECorridorType::HStraight && FirstHallway.Type != ECorridorType::Stairs)
+		{
+			continue;
+		}
+		for (int j = i + 1; j < NumHallways; ++j)
+		{
+			FDungeonHallwaySegment& SecondHallway = DungeonHallways[j];
+			if(SecondHallway.Type != ECorridorType::HStraight && SecondHallway.Type != ECorridorType::Stairs)
+			{
+				continue;
+			}
+
+			bool AreColinear = FirstHallway.Direction.GetAbs().Equals(SecondHallway.Direction.GetAbs());
+			if(!AreColinear)
+			{
+				continue;
+			}
+
+			const FVector FirstInvertedDirection(!FirstHallway.Direction.X,!FirstHallway.Direction.Y, !FirstHallway.Direction.Z);
+			const FVector SecondInvertedDirection(!SecondHallway.Direction.X,!SecondHallway.Direction.Y, !SecondHallway.Direction.Z);
+			const FVector FirstNegatedStart = FirstHallway.Start*FirstInvertedDirection;
+			const FVector SecondNegatedStart = SecondHallway.Start*SecondInvertedDirection;
+			if(!FirstNegatedStart.Equals(SecondNegatedStart))
+			{
+				continue;
+			}
+
+			if(FirstHallway.Direction.Equals(SecondHallway.Direction))
+			{
+				if(FirstHallway.Start.Equals(SecondHallway.End))
+				{
+					FirstHallway.Start = SecondHallway.Start;
+					SecondHallway.bIsInvalid = true;
+				}
+				else if(FirstHallway.End.Equals(SecondHallway.Start))
+				{
+					FirstHallway.End = SecondHallway.End;
+					SecondHallway.bIsInvalid = true;
+				}
+				else if(FirstHallway.Start.Equals(SecondHallway.Start) || FirstHallway.End.Equals(SecondHallway.End))
+				{
+					if(FVector::Dist(FirstHallway.Start, FirstHallway.End) > FVector::Dist(SecondHallway.Start, SecondHallway.End))
+					{
+						SecondHallway.bIsInvalid = true;
+					}
+					else
+					{
+						FirstHallway.bIsInvalid = true;
+					}
+				}
+			}
+			else
+			{
+				if(FirstHallway.Start.Equals(SecondHallway.Start))
+				{
+					FirstHallway.Start = SecondHallway.End;
+					SecondHallway.bIsInvalid = true;
+				}
+				else if(FirstHallway.End.Equals(SecondHallway.End))
+				{
+					FirstHallway.End = SecondHallway.Start;
+					SecondHallway.bIsInvalid = true;
+				}
+				else if(FirstHallway.Start.Equals(SecondHallway.End) || FirstHallway.End.Equals(SecondHallway.Start))
+				{
+					if(FVector::Dist(FirstHallway.Start, FirstHallway.End) > FVector::Dist(SecondHallway.Start, SecondHallway.End))
+					{
+						SecondHallway.bIsInvalid = true;
+					}
+					else
+					{
+						FirstHallway.bIsInvalid = true;
+					}
+				}
+			}
+		}
+	}
+
+	DungeonHallways.RemoveAll([](const FDungeonHallwaySegment& OtherHallWay)
+		{
+			return OtherHallWay.bIsInvalid;
+		});
+
+	if(Settings.bCreateCorners)
+	{
+		/// Create Corner sections of hallways
+	 	NumHallways = DungeonHallways.Num();
+	 	for (int i = 0; i < NumHallways; ++i)
+	 	{
+	 		const FDungeonHallwaySegment& FirstHallway = DungeonHallways[i];
+	 		if(FirstHallway.Type != ECorridorType::HStraight && FirstHallway.Type != ECorridorType::Stairs)
+	 		{
+	 			continue;
+	 		}
+	 		for (int j = i + 1; j < NumHallways; ++j)
+	 		{
+	 			const FDungeonHallwaySegment& SecondHallway = DungeonHallways[j];
+	 			if(SecondHallway.Type != ECorridorType::HStraight && SecondHallway.Type != ECorridorType::Stairs)
+	 			{
+	 				continue;
+	 			}
+
+	 			FVector IntersectionPoint1 = FVector::ZeroVector;
+	 			FVector IntersectionPoint2 = FVector::ZeroVector;
+	 			FMath::SegmentDistToSegmentSafe(FirstHallway.Start, FirstHallway.End, SecondHallway.Start, SecondHallway.End, IntersectionPoint1, IntersectionPoint2);
+	 			bool bIntersect = IntersectionPoint1.Equals(IntersectionPoint2);
+	 			if(bIntersect)
+	 			{
+	 				FVector CornerStart;
+	 				FVector CornerPoint = IntersectionPoint1;
+	 				FVector CornerEnd;
+	 				if(FirstHallway.End.Equals(CornerPoint))
+	 				{
+	 					CornerStart = FirstHallway.Start;
+	 					CornerEnd = SecondHallway.End;
+	 				}
+	 				else if(FirstHallway.Start.Equals(CornerPoint))
+	 				{
+	 					CornerStart = SecondHallway.Start;
+	 					CornerEnd = FirstHallway.End;
+	 				}
+	 				else if(SecondHallway.End.Equals(CornerPoint))
+	 				{
+	 					CornerStart = SecondHallway.Start;
+	 					CornerEnd = FirstHallway.End;
+	 				}
+	 				else if(SecondHallway.Start.Equals(CornerPoint))
+	 				{
+	 					CornerStart = FirstHallway.Start;
+	 					CornerEnd = SecondHallway.End;
+	 				}
+				    else
+				    {
+					    continue;
+				    }
+
+	 				FVector HallwayDirection = (CornerPoint - CornerStart).GetSafeNormal();
+
+	 				FDungeonHallwaySegment NewCorner;
+	 				NewCorner.Start = CornerPoint - HallwayDirection * Settings.HallWaySectionDimensions.X;
+	 				NewCorner.End = CornerPoint + (CornerEnd - CornerPoint).GetSafeNormal() * Settings.HallWaySectionDimensions.X;
+	 				NewCorner.Direction = HallwayDirection;
+	 				const bool IsStairs = (NewCorner.End.Z - NewCorner.Start.Z) != 0;
+	 				NewCorner.Type = IsStairs ? ECorridorType::StairConnection : ECorridorType::HCorner;
+	 				DungeonHallways.Add(NewCorner);
+	 			}
+	 		}
+	 	}
+	}
+	SET_DWORD_STAT(STAT_HallwaySegmentCount, DungeonHallways.Num());
+}
+
+void FDungeonLayout::SplitHallwaysCrossingRooms(int32 FirstHallwayIdx)
+{
+	TArray<FDungeonHallwaySegment> NewHallways;
+	TArray<int32> CrossedRooms;
+	const FVector HallwayHalfExtent = GetHallwayHalfExtent();
+	for (int32 HallwayIdx = FirstHallwayIdx; HallwayIdx < DungeonHallways.Num(); ++HallwayIdx)
+	{
+		FDungeonHallwaySegment& HallWay = DungeonHallways[HallwayIdx];
+		RoomBVH.QuerySegment(HallWay.Start, HallWay.End, HallwayHalfExtent, CrossedRooms);
+		for (const int32 RoomIdx : CrossedRooms)
+		{
+			FDungeonNode& Room = DungeonNodes[RoomIdx];
+			FDungeonHallwaySegment NewHallway;
+			if(FixHallwayCrossingRoom(Room, HallWay.Start, HallWay.End, NewHallway))
+			{
+				NewHallways.Add(NewHallway);
+				HallWay.bIsInvalid = true;
+
+				FDungeonHallwaySegment NewHallwayConnection;
+				if(CreateConnectionFromEdgePoint(Room, NewHallway.End, NewHallway.Start, NewHallwayConnection))
+				{
+					NewHallways.Add(NewHallwayConnection);
+				}
+			}
+
+			if(FixHallwayCrossingRoom(Room, HallWay.End, HallWay.Start, NewHallway))
+			{
+				NewHallways.Add(NewHallway);
+				HallWay.bIsInvalid = true;
+
+				FDungeonHallwaySegment NewHallwayConnection;
+				if(CreateConnectionFromEdgePoint(Room, NewHallway.End, NewHallway.Start, NewHallwayConnection))
+				{
+					NewHallways.Add(NewHallwayConnection);
+				}
+			}
+		}
+	}
+
+	DungeonHallways.RemoveAll([](const FDungeonHallwaySegment& OtherHallWay)
+		{
+			return OtherHallWay.bIsInvalid;
+		});
+	DungeonHallways.Append(NewHallways);
+}
+
+bool FDungeonLayout::CreateConnectionFromEdgePoint(FDungeonNode& ConnectedRoom, FVector Start, FVector End, FDungeonHallwaySegment& OutHallway) const
+{
+	if(!Settings.bHallwayToRoomConnection)
+	{
+		return false;
+	}
+	const FRotator StartRoomDoorRotation = (End - Start).Rotation();
+	const FTransform StartDoorTransform = FTransform(StartRoomDoorRotation, Start);
+	ConnectedRoom.Doors.Add(StartDoorTransform);
+	if(FVector::Distance(End, Start) >= Settings.HallWaySectionDimensions.X)
+	{//Create Start door connection hallway
+		OutHallway = FDungeonHallwaySegment();
+		OutHallway.Direction = StartDoorTransform.GetUnitAxis(EAxis::X);
+		OutHallway.Start = StartDoorTransform.GetLocation();
+		OutHallway.End = OutHallway.Start + OutHallway.Direction * (Settings.HallWaySectionDimensions.X * 0.5f);
+		const bool IsVerticalCorridor = OutHallway.Direction.GetAbs().Equals(FVector::UpVector);
+		OutHallway.Type = IsVerticalCorridor ? ECorridorType::VRoomConnection : ECorridorType::HRoomConnection;
+		return true;
+	}
+	return false;
+}
+
+bool FDungeonLayout::FixHallwayCrossingRoom(const FDungeonNode& Room, const FVector& Start, const FVector& End, FDungeonHallwaySegment& OutHallway) const
+{
+	FVector HitLocation = FVector::ZeroVector;
+	FVector HitNormal = FVector::ZeroVector;
+	float HitTime = 0.0f;
+	//Swept only across the hallway, so a hallway running into the room is still cut right at the wall its door goes on
+	const FVector SectionExtent = GetHallwayHalfExtent() * (FVector::OneVector - (End - Start).GetSafeNormal().GetAbs());
+	const bool Interect = FMath::LineExtentBoxIntersection(Room.GetBounds(), Start, End, SectionExtent, HitLocation, HitNormal, HitTime);
+	if(Interect && HitTime > 0.0f &&  !FMath::IsNearlyEqual(HitTime, 1.0f, 0.00001f) )
+	{
+		OutHallway = FDungeonHallwaySegment(Start, HitLocation, ECorridorType::HStraight);
+		return true;
+	}
+	return false;
+}
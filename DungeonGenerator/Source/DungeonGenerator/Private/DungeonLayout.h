@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonGeneratorStats.h"
+#include "DungeonGraph.h"
+#include "DungeonMapperData.h"
+#include "DungeonOccupancyGrid.h"
+#include "DungeonParallelTriangulator.h"
+#include "DungeonPathFinder.h"
+#include "DungeonRoomBVH.h"
+#include "Tasks/Task.h"
+
+/** Everything a layout needs to be generated. Filled from ADungeonMapper, or by hand when generating without an actor. */
+struct FDungeonLayoutSettings
+{
+	int32 MinRooms = 0;
+	int32 MaxRooms = 0;
+	//Half depth, width and height of a room. X - Min, Y - Max
+	FVector2D RoomXExtent = FVector2D::ZeroVector;
+	FVector2D RoomYExtent = FVector2D::ZeroVector;
+	FVector2D RoomZExtent = FVector2D::ZeroVector;
+	int32 RandomSeed = 0;
+	//Area the rooms are spawned in and clamped to while collapsing
+	FBox Bounds = FBox(ForceInit);
+	ERoomPlacementMethod RoomPlacementMethod = ERoomPlacementMethod::RandomCell;
+
+	float MaxHallwaySlope = 45.0f;
+	EHallwayGenerationMethod HallWayGenerationMethod = EHallwayGenerationMethod::Basic;
+	//X - Width. Y - Height
+	FVector2D HallWaySectionDimensions = FVector2D::ZeroVector;
+	//Path found hallways route around rooms and avoid other hallways, basic ones are split where they cross a room
+	bool bPreventCrossing = false;
+	bool bCreateCorners = false;
+	bool bHallwayToRoomConnection = false;
+	EConnectionSimplificationMethod ConnectionSimplificationMethod = EConnectionSimplificationMethod::ShortestPathTree;
+	//Fraction of the connections left out of the minimum spanning tree that are added back as loops
+	float ExtraConnectionRatio = 0.0f;
+	//Longest detour the greedy spanner allows between two connected rooms, relative to their connection length
+	float SpannerStretch = 1.5f;
+	//Safety net for the path finder, a hallway search expanding more nodes than this is abandoned for a basic hallway
+	int32 MaxPathFinderIterations = 100000;
+	ETriangulationBackend TriangulationBackend = ETriangulationBackend::Auto;
+	//Room count from which the Auto backend triangulates over several threads, 0 never does. Same connections either way
+	int32 ParallelTriangulationMinRooms = FDungeonParallelTriangulator::MinParallelPoints;
+
+	float SpringConstant = 1.0f;
+	float SpringForcePreservation = 1.0f;
+	bool bApplyNodeRepulsion = false;
+	bool bApplySpringForce = false;
+	//Fixed step and iteration cap used when collapsing outside of Tick
+	float CollapseTimeStep = 1.0f / 30.0f;
+	int32 MaxCollapseIterations = 1000;
+};
+
+/**
+ * UObject free dungeon layout. Owns the rooms, their connections and the hallway segments, and runs every generation
+ * stage on them without touching the world, so a layout can be built from any thread and several can coexist.
+ */
+class DUNGEONGENERATOR_API FDungeonLayout
+{
+public:
+	//Candidates tried around a room before it stops spawning neighbours when placing rooms with Poisson disk sampling
+	static constexpr int32 PoissonDiskAttempts = 30;
+	//Fraction of the even spacing used between Poisson disk rooms. Below one so the bounds fit more rooms than requested
+	static constexpr double PoissonDiskDensity = 0.6;
+
+	FDungeonLayout() {}
+	explicit FDungeonLayout(const FDungeonLayoutSettings& InSettings)
+		: Settings(InSettings)
+	{}
+
+	/** Runs every stage to completion: rooms, connections, collapse, simplification and hallways. */
+	void Generate();
+	/** Runs Generate on a worker thread. The task result is the finished layout. */
+	static UE::Tasks::TTask<FDungeonLayout> GenerateAsync(const FDungeonLayoutSettings& InSettings);
+	void Reset();
+
+	void GenerateRooms();
+	void ConnectRooms();
+	void SimplifyConnections();
+
+	/** Runs the physics collapse until the rooms settle or MaxCollapseIterations is reached. */
+	void Collapse();
+	void BeginCollapse();
+	/** Advances the collapse by one step. Returns true while the rooms are still moving. */
+	bool StepCollapse(float DeltaSeconds);
+
+	/** Creates every hallway. Path found ones are searched in parallel, one job per connection. */
+	void CreateHallways();
+	/** Basic hallways are created right away, path found ones are advanced by StepHallwaysCreation. */
+	void BeginHallwaysCreation();
+	/** Runs path finder iterations for TimeBudgetSeconds, moving on to the next connections as searches finish. A budget
+	 * of 0 runs a single iteration. Returns true once every hallway has been created. */
+	bool StepHallwaysCreation(double TimeBudgetSeconds = 0.0);
+	bool IsCreatingHallways() const { return bIsCreatingHallways; }
+	/** Fraction of the connections whose hallway search is over, 1 when no hallways are being created. */
+	float GetHallwaysCreationProgress() const;
+	const FDungeonHallwayPathFinder& GetHallwayPathFinder() const { return HallwayPathFinder; }
+
+private:
+	//Room placement
+	FVector RandomRoomExtent(const FRandomStream& RandomStream) const;
+	void PlaceRoomsInCells(const FRandomStream& RandomStream);
+	void PlaceRoomsPoissonDisk(const FRandomStream& RandomStream);
+
+	//Connection simplification
+	/** Dijkstra over RoomGraph. Rooms get their distance, the connection reaching them and the rooms on their path.
+	 * The connection is INDEX_NONE for StartRoom and the rooms it can't reach. */
+	void FindShortestPaths(int32 StartRoom, TArray<double>& OutDistances, TArray<int32>& OutPathConnections, TArray<int32>& OutPathRooms) const;
+	void SelectSpanningTreeConnections(const FRandomStream& RandomStream, TArray<bool>& OutUsedConnections) const;
+	void SelectSpannerConnections(TArray<bool>& OutUsedConnections) const;
+	/** Connection lengths and the connection indices from the shortest to the longest. */
+	void SortConnectionsByLength(TArray<double>& OutLengths, TArray<int32>& OutSortedConnections) const;
+
+	//Connection creation
+	/** Tries a connection for every Delaunay edge, given as FDungeonTriangulator::MakeEdge keys. */
+	void GenerateConnectionFromEdges(TConstArrayView<uint64> Edges);
+	void TryCreateConnection(int32 StartRoomIdx, int32 EndRoomIdx);
+
+	//Hallway Creation
+	void CreateBasicHallways(const FDungeonConnection& Connection);
+	/** Basic hallway for a connection the path finder found no path for, split where it crosses a room when preventing
+	 * crossings, so the rooms stay connected. */
+	void CreateFallbackHallways(int32 ConnectionIdx);
+	/** Rasterizes the rooms as path finder obstacles and empties the hallway occupancy. */
+	void BuildOccupancy();
+	/** Distance kept between a hallway center and the rooms it doesn't connect. */
+	FVector GetRoomObstacleMargin() const;
+	/** Half size of a hallway section, swept along a segment to test the space the hallway takes. */
+	FVector GetHallwayHalfExtent() const;
+	/** bBlockHallways makes AvoidedHallways obstacles, otherwise they only add to the path cost. */
+	void InitializePathFinder(FDungeonHallwayPathFinder& PathFinder, const FDungeonConnection& Connection, const FDungeonOccupancyGrid* AvoidedHallways, bool bBlockHallways = true) const;
+	/** Points the path finder at this layout's room grid. Set before every search step, a copied or moved layout keeps
+	 * pointers into the grids of the one it came from. */
+	void SetPathFinderOccupancy(FDungeonHallwayPathFinder& PathFinder, const FDungeonOccupancyGrid* AvoidedHallways) const;
+	/** Runs a whole search for the connection. OutPath stays empty if there is no path or it gave up after MaxPathFinderIterations.
+	 * OutPathLocations gets the lattice locations the path goes through, if given. */
+	void FindHallwayPath(int32 ConnectionIdx, const FDungeonOccupancyGrid* AvoidedHallways, bool bBlockHallways, TArray<FVector>& OutPath, TArray<FVector>* OutPathLocations = nullptr) const;
+	/** Searches around the created hallways, and through them only if that finds no path. */
+	void FindHallwayPathAroundHallways(int32 ConnectionIdx, TArray<FVector>& OutPath) const;
+	/** Whether a path searched without the created hallways runs into one, so it would be blocked knowing about them.
+	 * Same test as the path finder: its cells and the middle of its moves, away from the rooms it connects. */
+	bool IsPathOverlappingHallways(const FDungeonConnection& Connection, const TArray<FVector>& PathLocations) const;
+	void CreateHallwaysFromPath(const TArray<FVector>& Path);
+	void FinishHallways();
+	/** Cuts the hallways from FirstHallwayIdx on where they cross a room, and connects the pieces to it. */
+	void SplitHallwaysCrossingRooms(int32 FirstHallwayIdx);
+	bool CreateConnectionFromEdgePoint(FDungeonNode& ConnectedRoom, FVector Start, FVector End, FDungeonHallwaySegment& OutHallway) const;
+	bool FixHallwayCrossingRoom(const FDungeonNode& Room, const FVector& Start, const FVector& End, FDungeonHallwaySegment& OutHallway) const;
+
+public:
+	FDungeonLayoutSettings Settings;
+
+	TArray<FDungeonNode> DungeonNodes;
+	TArray<FDungeonConnection> DungeonConnections;
+	//Connections of every room, rebuilt whenever DungeonConnections changes
+	FDungeonGraph RoomGraph;
+	TArray<FDungeonHallwaySegment> DungeonHallways;
+	FBox DungeonBounds = FBox(ForceInit);
+	//Room bounds for segment, swept box and point queries, built by ConnectRooms and refit while collapsing
+	FDungeonRoomBVH RoomBVH;
+
+	//Tetrahedrons produced by the last ConnectRooms, super tetrahedron leftovers included for the Bowyer-Watson backends
+	int32 TetrahedronCount = 0;
+	//Path from the Starting room to the End room, filled by SimplifyConnections
+	float CriticalPathLength = 0.0f;
+	int32 CriticalPathRoomCount = 0;
+
+private:
+	//Collapsing Variables
+	bool bIsCollapsing = false;
+	int32 CollapsingIterationNotModified = 0;
+
+	//HallCreation Variables
+	bool bIsCreatingHallways = false;
+	int32 ConnectionID = 0;
+	int32 PathFinderIterations = 0;
+	FDungeonHallwayPathFinder HallwayPathFinder;
+	//Path finder obstacles and the hallways created so far, filled when preventing crossings
+	FDungeonOccupancyGrid RoomOccupancy;
+	FDungeonOccupancyGrid HallwayOccupancy;
+};
@@ -3,23 +3,15 @@
 
 #include "DungeonMapper.h"
 
-#include "DungeonPathFinder.h"
 #include "DungeonRoom.h"
 #include "GeometryScriptLibrary_DungeonGenerationFunctions.h"
 #include "NavigationSystem.h"
-#include "TriangulatorData.h"
+#include "Async/Async.h"
 #include "GeometryScript/CollisionFunctions.h"
 #include "GeometryScript/MeshBooleanFunctions.h"
 #include "GeometryScript/MeshPrimitiveFunctions.h"
 #include "Runtime/GeometryFramework/Public/Components/DynamicMeshComponent.h"
 
-DEFINE_LOG_CATEGORY(LogDungeonGenerator);
-
-// PROFILER INTEGRATION //
-DEFINE_STAT(STAT_GenerateRooms);
-DEFINE_STAT(STAT_ConnectRooms);
-DEFINE_STAT(STAT_SimplifyConections);
-DEFINE_STAT(STAT_RenderDungeon);
 ENUM_RANGE_BY_COUNT(ECorridorType, ECorridorType::Count)
 ADungeonMapper::ADungeonMapper(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer),
@@ -40,8 +32,6 @@ ADungeonMapper::ADungeonMapper(const FObjectInitializer& ObjectInitializer)
 	{
 		HallwayDebugColors.Add(Type, FColor::Orange);
 	}
-
-	DungeonHallwayPathFinder = NewObject<UDungeonHallwayPathFinder>(this, TEXT("HallWayPathFinder"));
 }
 
 void ADungeonMapper::Tick(float DeltaSeconds)
@@ -66,378 +56,109 @@ void ADungeonMapper::PostEditChangeProperty(FPropertyChangedEvent& PropertyChang
 	}	
 }
 
-void ADungeonMapper::CreateHallwaysFromPath(const TArray<FVector>& Path)
+bool ADungeonMapper::GenerateDungeonAsync()
 {
-	for (int i = 0; i <Path.Num() - 1; ++i)
-	{
-		UDungeonHallwayData* NewHallway = DuplicateObject(HallwayData, this);
-		NewHallway->Start = Path[i];
-		NewHallway->End = Path[i + 1];
-		NewHallway->Direction = (NewHallway->End - NewHallway->Start).GetSafeNormal();
-		const bool IsStairs = (NewHallway->End.Z - NewHallway->Start.Z) != 0;
-		NewHallway->Type = IsStairs ? ECorridorType::Stairs : ECorridorType::HStraight;
-			
-		DungeonHallwaysData.AddUnique(NewHallway);
-	}
-
-	if(bPreventCrossing)
+	FDungeonLayoutSettings Settings;
+	if(!MakeLayoutSettings(Settings))
 	{
-		TArray< UDungeonHallwayData*> NewHallways;
-		for (UDungeonHallwayData* HallWay : DungeonHallwaysData)
-		{
-			for (UDungeonRoomData* Room : DungeonNodes)
-			{
-					UDungeonHallwayData* NewHallway = FixHallwayCrossingRoom(Room,  HallWay->Start, HallWay->End);
-					if(NewHallway)
-					{
-						NewHallways.AddUnique(NewHallway);
-						HallWay->bIsInvalid = true;
-	
-						UDungeonHallwayData* NewHallwayConnection = CreateConnectionFromEdgePoint(Room, NewHallway->End, NewHallway->Start);
-						if(NewHallwayConnection)
-						{
-							NewHallways.AddUnique(NewHallwayConnection);
-						}
-					}
-	
-					NewHallway = FixHallwayCrossingRoom(Room,  HallWay->End, HallWay->Start);
-					if(NewHallway)
-					{
-						NewHallways.AddUnique(NewHallway);
-						HallWay->bIsInvalid = true;
-	
-						UDungeonHallwayData* NewHallwayConnection = CreateConnectionFromEdgePoint(Room,NewHallway->End, NewHallway->Start);
-						if(NewHallwayConnection)
-						{
-							NewHallways.AddUnique(NewHallwayConnection);
-						}
-					}
-				}
-		}
-	
-		
-		DungeonHallwaysData.RemoveAll([](const UDungeonHallwayData* OtherHallWay)
-			{
-				return OtherHallWay->bIsInvalid;
-			});
-		DungeonHallwaysData.Append(NewHallways);
+		return false;
 	}
+	bIsCollapsing = false;
+	bIsCreatingHallways = false;
+	bIsGeneratingAsync = true;
+	const int32 GenerationID = ++AsyncGenerationID;
 
-	//Merge Hallways that fallow the same path
-	int32 NumHallways = DungeonHallwaysData.Num();
-	for (int i = 0; i < NumHallways; ++i)
+	UE::Tasks::TTask<FDungeonLayout> GenerationTask = FDungeonLayout::GenerateAsync(Settings);
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis = TWeakObjectPtr<ADungeonMapper>(this), GenerationTask, GenerationID]() mutable
 	{
-		UDungeonHallwayData* FirstHallway = DungeonHallwaysData[i];
-		if(FirstHallway->Type != ECorridorType::HStraight && FirstHallway->Type != ECorridorType::Stairs)
+		//Actors and meshes can only be touched from the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, GeneratedLayout = MoveTemp(GenerationTask.GetResult()), GenerationID]() mutable
 		{
-			continue;
-		}
-		for (int j = i + 1; j < NumHallways; ++j)
-		{
-			UDungeonHallwayData* SecondHallway = DungeonHallwaysData[j];
-			if(SecondHallway->Type != ECorridorType::HStraight && SecondHallway->Type != ECorridorType::Stairs)
+			if(ADungeonMapper* DungeonMapper = WeakThis.Get())
 			{
-				continue;
+				DungeonMapper->FinishGenerationAsync(MoveTemp(GeneratedLayout), GenerationID);
 			}
+		});
+	}, GenerationTask);
+	return true;
+}
 
+void ADungeonMapper::GenerateDungeonAsyncInEditor()
+{
+	GenerateDungeonAsync();
+}
 
-			bool AreColinear = FirstHallway->Direction.GetAbs().Equals(SecondHallway->Direction.GetAbs());
-			if(!AreColinear)
-			{
-				continue;
-			}
-			
-			const FVector FirstInvertedDirection(!FirstHallway->Direction.X,!FirstHallway->Direction.Y, !FirstHallway->Direction.Z);
-			const FVector SecondInvertedDirection(!SecondHallway->Direction.X,!SecondHallway->Direction.Y, !SecondHallway->Direction.Z);
-			const FVector FirstNegatedStart = FirstHallway->Start*FirstInvertedDirection;
-			const FVector SecondNegatedStart = SecondHallway->Start*SecondInvertedDirection;
-			if(!FirstNegatedStart.Equals(SecondNegatedStart))
-			{
-				continue;
-			}
+TArray<FDungeonSeedResult> ADungeonMapper::FindSeeds(const TArray<FName>& CandidateSeeds, const FDungeonSeedConstraints& Constraints) const
+{
+	FDungeonLayoutSettings Settings;
+	if(!MakeLayoutSettings(Settings))
+	{
+		return TArray<FDungeonSeedResult>();
+	}
 
-			if(FirstHallway->Direction.Equals(SecondHallway->Direction))
-			{
-				if(FirstHallway->Start.Equals(SecondHallway->End))
-				{
-					FirstHallway->Start = SecondHallway->Start;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->End.Equals(SecondHallway->Start))
-				{
-					FirstHallway->End = SecondHallway->End;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->Start.Equals(SecondHallway->Start) || FirstHallway->End.Equals(SecondHallway->End))
-				{
-					if(FVector::Dist(FirstHallway->Start, FirstHallway->End) > FVector::Dist(SecondHallway->Start, SecondHallway->End))
-					{
-						SecondHallway->bIsInvalid = true;
-					}
-					else
-					{
-						FirstHallway->bIsInvalid = true;
-					}
-				}
-			}
-			else
-			{
-				if(FirstHallway->Start.Equals(SecondHallway->Start))
-				{
-					FirstHallway->Start = SecondHallway->End;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->End.Equals(SecondHallway->End))
-				{
-					FirstHallway->End = SecondHallway->Start;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->Start.Equals(SecondHallway->End) || FirstHallway->End.Equals(SecondHallway->Start))
-				{
-					if(FVector::Dist(FirstHallway->Start, FirstHallway->End) > FVector::Dist(SecondHallway->Start, SecondHallway->End))
-					{
-						SecondHallway->bIsInvalid = true;
-					}
-					else
-					{
-						FirstHallway->bIsInvalid = true;
-					}
-				}
-			}
-		}
+	TArray<int32> Seeds;
+	Seeds.Reserve(CandidateSeeds.Num());
+	for (const FName& CandidateSeed : CandidateSeeds)
+	{
+		Seeds.Add(FRandomStream(CandidateSeed).GetInitialSeed());
 	}
+	return FDungeonSeedSearch::FindSeeds(Settings, Seeds, Constraints);
+}
 
-	DungeonHallwaysData.RemoveAll([](const UDungeonHallwayData* OtherHallWay)
-		{
-			return OtherHallWay->bIsInvalid;
-		});
-	
-	if(bCreateCorners)
+void ADungeonMapper::FinishGenerationAsync(FDungeonLayout&& GeneratedLayout, int32 GenerationID)
+{
+	if(GenerationID != AsyncGenerationID || !bIsGeneratingAsync)
 	{
-		/// Create Corner sections of hallways
-	 	NumHallways = DungeonHallwaysData.Num();
-	 	for (int i = 0; i < NumHallways; ++i)
-	 	{
-	 		UDungeonHallwayData* FirstHallway = DungeonHallwaysData[i];
-	 		if(FirstHallway->Type != ECorridorType::HStraight && FirstHallway->Type != ECorridorType::Stairs)
-	 		{
-	 			continue;
-	 		}
-	 		for (int j = i + 1; j < NumHallways; ++j)
-	 		{
-	 			UDungeonHallwayData* SecondHallway = DungeonHallwaysData[j];
-	 			if(SecondHallway->Type != ECorridorType::HStraight && SecondHallway->Type != ECorridorType::Stairs)
-	 			{
-	 				continue;
-	 			}
+		return;
+	}
+	bIsGeneratingAsync = false;
+	SetLayout(MoveTemp(GeneratedLayout));
+	RenderDungeon();
+	OnDungeonGenerated.Broadcast(this, true);
+}
 
-	 			FVector IntersectionPoint1 = FVector::ZeroVector;
-	 			FVector IntersectionPoint2 = FVector::ZeroVector;
-	 			FMath::SegmentDistToSegmentSafe(FirstHallway->Start, FirstHallway->End, SecondHallway->Start, SecondHallway->End, IntersectionPoint1, IntersectionPoint2);
-	 			bool bIntersect = IntersectionPoint1.Equals(IntersectionPoint2);
-	 			if(bIntersect)
-	 			{
-	 				
-	 				FVector CornerStart;
-	 				FVector CornerPoint = IntersectionPoint1;
-	 				FVector CornerEnd;
-	 				if(FirstHallway->End.Equals(CornerPoint))
-	 				{
-	 					CornerStart = FirstHallway->Start;
-	 					CornerEnd = SecondHallway->End;
-	 				}
-	 				else if(FirstHallway->Start.Equals(CornerPoint))
-	 				{
-	 					CornerStart = SecondHallway->Start;
-	 					CornerEnd = FirstHallway->End;
-	 				}
-	 				else if(SecondHallway->End.Equals(CornerPoint))
-	 				{
-	 					CornerStart = SecondHallway->Start;
-	 					CornerEnd = FirstHallway->End;
-	 				}
-	 				else if(SecondHallway->Start.Equals(CornerPoint))
-	 				{
-	 					CornerStart = FirstHallway->Start;
-	 					CornerEnd = SecondHallway->End;
-	 				}
-				    else
-				    {
-					    continue;
-				    }
-	 				
-	 				FVector HallwayDirection = (CornerPoint - CornerStart).GetSafeNormal();
-	 			
-	 				UDungeonHallwayData* NewCorner = DuplicateObject(HallwayData, this);
-	 				NewCorner->Start = CornerPoint - HallwayDirection * NewCorner->HallWaySectionDimensions.X;
-	 				NewCorner->End = CornerPoint + (CornerEnd - CornerPoint).GetSafeNormal() * NewCorner->HallWaySectionDimensions.X;
-	 				NewCorner->Direction = HallwayDirection;
-	 				const bool IsStairs = (NewCorner->End.Z - NewCorner->Start.Z) != 0;
-	 				NewCorner->Type = IsStairs ? ECorridorType::StairConnection : ECorridorType::HCorner;
-	 				DungeonHallwaysData.AddUnique(NewCorner);
-	 				
-	 			}
-	 		}
-	 	}
+void ADungeonMapper::SetLayout(FDungeonLayout&& InLayout)
+{
+	DungeonLayout = MoveTemp(InLayout);
+	bIsCollapsing = false;
+	bIsCreatingHallways = false;
+}
+
+int32 ADungeonMapper::GetRenderedTriangleCount() const
+{
+	int32 TriangleCount = DynamicMeshComponent->GetDynamicMesh()->GetTriangleCount();
+	for (const ADungeonRoom* DungeonRoom : DungeonRooms)
+	{
+		TriangleCount += DungeonRoom->GetTriangleCount();
 	}
+	return TriangleCount;
 }
 
 void ADungeonMapper::RunHallwaysCreation()
 {
 	if(bIsCreatingHallways)
 	{
-		if(!DungeonConnections.IsValidIndex(ConnectionID))
-		{
-			bIsCreatingHallways = false;
-			return;
-		}
-		
-		if(DungeonHallwayPathFinder->Evaluate())
-		{
-			CreateHallwaysFromPath(DungeonHallwayPathFinder->PathResult);
-			ConnectionID++;
-			if(DungeonConnections.IsValidIndex(ConnectionID))
-			{
-				DungeonHallwayPathFinder->PathStartLocation = DungeonConnections[ConnectionID].StartRoom->Location;
-				DungeonHallwayPathFinder->StartRoomExtent = DungeonConnections[ConnectionID].StartRoom->Extent;
-				DungeonHallwayPathFinder->EndRoomExtent = DungeonConnections[ConnectionID].EndRoom->Extent;
-				DungeonHallwayPathFinder->FillAdditionalValidConnectionDirections(DungeonConnections[ConnectionID].StartRoom->Location, DungeonConnections[ConnectionID].EndRoom->Location);
-				DungeonHallwayPathFinder->Initialize(DungeonConnections[ConnectionID].StartRoom->Location, DungeonConnections[ConnectionID].EndRoom->Location);
-			}
-		}
+		bIsCreatingHallways = !DungeonLayout.StepHallwaysCreation(HallwayFrameBudgetMs / 1000.0);
 	}
 }
 
 void ADungeonMapper::RunPhysics(float DeltaSeconds)
 {
-	if(bIsCollapsing && !DungeonNodes.IsEmpty())
+	if(bIsCollapsing)
 	{
-		bIsCollapsing = false;
-		for (int i = 0; i < DungeonNodes.Num(); ++i)
-		{
-			UDungeonRoomData* FirstNode = DungeonNodes[i];
-			FSphere FirstNodeSphere(FirstNode->Location, FirstNode->Extent.Size() + HallwayData->HallWaySectionDimensions.X);
-			FVector Force = FVector::ZeroVector;
-			DrawDebugSphere(GetWorld(), FirstNode->Location, FirstNodeSphere.W, 32, FColor::Green);
-			if(FirstNode->RoomType == ERoomType::Starting || FirstNode->RoomType == ERoomType::End)
-			{
-				continue;
-			}
-			
-			if(bApplyNodeRepulsion)
-			{
-				
-				for (int j = 0; j < DungeonNodes.Num(); ++j)
-				{
-				
-					UDungeonRoomData* SecondNode = DungeonNodes[j];
-					if(FirstNode == SecondNode)
-					{
-						continue;
-					}
-					FSphere SecondNodeSphere(SecondNode->Location, SecondNode->Extent.Size() + HallwayData->HallWaySectionDimensions.X);
-					FVector InteractionDirection = FirstNode->Location - SecondNode->Location;
-					const float NodeSeparation = InteractionDirection.Size();
-					const float Distance = NodeSeparation - (FirstNodeSphere.W + SecondNodeSphere.W);
-					constexpr float G = 6.6743E-11;
-					const float FirstSphereVolume = FirstNodeSphere.GetVolume();
-					const float SecondSphereVolume = SecondNodeSphere.GetVolume();
-					const float RepulsionMagnitude = G * (FirstSphereVolume)  * (SecondSphereVolume) / (Distance * Distance);
-					Force += InteractionDirection.GetSafeNormal() * RepulsionMagnitude;
-				}
-				DrawDebugDirectionalArrow(GetWorld(), FirstNode->Location, FirstNode->Location+Force,10.0f,  FColor::Blue);
-				uint64 InnerKey = GetTypeHash(FirstNode->GetName()+ "RepulsionForce");
-				GEngine->AddOnScreenDebugMessage(InnerKey, 2.0f, FColor::Blue, FString::Printf(TEXT("Repulsion: [M]%f | [D]%s"), Force.Length(), *Force.GetSafeNormal().ToString()));
-			}			
-			
-			//Hooks Law Fspring = -K*X
-			// X = current length - resting length
-			// K = spring Constant
-			if(bApplySpringForce)
-			{
-				for (const FDungeonConnection* Connection : FirstNode->Connections)
-				{
-					FSphere SecondNodeSphere;
-					if(Connection->StartRoom == FirstNode)
-					{
-						SecondNodeSphere = FSphere(Connection->EndRoom->Location, Connection->EndRoom->Extent.Size());
-					}
-					else
-					{
-						SecondNodeSphere = FSphere(Connection->StartRoom->Location, Connection->StartRoom->Extent.Size());
-					}
-					
-					FVector Spring = FirstNodeSphere.Center - SecondNodeSphere.Center;
-					const float RestingDistance = FirstNodeSphere.W + SecondNodeSphere.W;
-					const float SpringSize = Spring.Size();
-					const float X = SpringSize - RestingDistance;
-					const FVector SpringForce = -SpringConstant * X * Spring.GetSafeNormal();
-					
-					DrawDebugPoint(GetWorld(), SecondNodeSphere.Center + Spring.GetSafeNormal() * RestingDistance, 10.0f, FColor::Green);
-					DrawDebugPoint(GetWorld(), FirstNodeSphere.Center, 10.0f, FColor::Red);
-					DrawDebugPoint(GetWorld(), SecondNodeSphere.Center, 10.0f, FColor::Blue);
-					DrawDebugDirectionalArrow(GetWorld(), FirstNodeSphere.Center,FirstNodeSphere.Center + SpringForce, 10.0f, FColor::Red);
-					uint64 InnerKey = GetTypeHash(FirstNode->GetName()+ "SpringForce");
-					GEngine->AddOnScreenDebugMessage(InnerKey, 2.0f, FColor::Red, FString::Printf(TEXT("Spring: [M]%f | [D]%s"), SpringForce.Length(), *SpringForce.GetSafeNormal().ToString()));
-					Force += SpringForce;
-				}			
-			}
-			FirstNode->Velocity += Force;
-		}
-		
-		FVector MinDungeonBounds = DungeonNodes[0]->Location -  DungeonNodes[0]->Extent;
-		FVector MaxDungeonBounds =  DungeonNodes[0]->Location +  DungeonNodes[0]->Extent;
-		bool IsStaticIteration = true;
-		for (UDungeonRoomData* Node : DungeonNodes)
-		{
-			Node->PrevLocation = Node->Location;
-			Node->Location += Node->Velocity*DeltaSeconds;
-			Node->Velocity *= SpringForcePreservation;
-			
-			FVector RoomMin = Node->Location - Node->Extent;
-			FVector RoomMax = Node->Location + Node->Extent;
-			
-			MinDungeonBounds.X = FMath::Min(RoomMin.X, MinDungeonBounds.X);
-			MinDungeonBounds.Y = FMath::Min(RoomMin.Y, MinDungeonBounds.Y);
-			MinDungeonBounds.Z = FMath::Min(RoomMin.Z, MinDungeonBounds.Z);
-
-			MaxDungeonBounds.X = FMath::Max(RoomMax.X, MaxDungeonBounds.X);
-			MaxDungeonBounds.Y = FMath::Max(RoomMax.Y, MaxDungeonBounds.Y);
-			MaxDungeonBounds.Z = FMath::Max(RoomMax.Z, MaxDungeonBounds.Z);
-
-			const UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent(GetWorld());
-			FBox NavBounds =NavSys->GetNavigableWorldBounds();
-			NavBounds = NavBounds.ExpandBy(-Node->Extent);
-			Node->Location = NavBounds.GetClosestPointTo(Node->Location);
-			if(!Node->Location.Equals(Node->PrevLocation))
-			{
-				IsStaticIteration = false;
-			}
-			if(!Node->Velocity.IsNearlyZero(0.0001))
-			{
-				bIsCollapsing = true;
-			}
-		}
-		DungeonBounds = FBox(MinDungeonBounds, MaxDungeonBounds);
-		if(IsStaticIteration)
-		{
-			CollapsingIterationNotModified++;
-		}
-		if(CollapsingIterationNotModified >= 10/*MaxStaticIterations*/)
-		{
-			bIsCollapsing = false;
-		}
+		bIsCollapsing = DungeonLayout.StepCollapse(DeltaSeconds);
 	}
 }
 
 void ADungeonMapper::Debug()
 {
+	const TArray<FDungeonNode>& DungeonNodes = DungeonLayout.DungeonNodes;
 	if(bShowRooms)
 	{
-		for (const UDungeonRoomData* DungeonsRoom : DungeonNodes)
+		for (const FDungeonNode& DungeonsRoom : DungeonNodes)
 		{
 			FColor DungeonColor;
-			switch (DungeonsRoom->RoomType) {
+			switch (DungeonsRoom.RoomType) {
 			case ERoomType::Starting:
 				DungeonColor = FColor::Green;
 				break;
@@ -450,711 +171,149 @@ void ADungeonMapper::Debug()
 			default:
 				DungeonColor = FColor::White;
 			}
-			DrawDebugBox(GetWorld(), DungeonsRoom->Location, DungeonsRoom->Extent,DungeonColor, false, TickInterval, 0, 2);
-			DrawDebugDirectionalArrow(GetWorld(), DungeonsRoom->Location, DungeonsRoom->Location + DungeonsRoom->Velocity, 10.0f, FColor::Black, false, TickInterval, 0, 2);
-			uint64 InnerKey = GetTypeHash(DungeonsRoom->GetName()+ "Velocity");
-			GEngine->AddOnScreenDebugMessage(InnerKey, 2.0f, FColor::Green, FString::Printf(TEXT("Velocity:  [M]%f | [D]%s"), DungeonsRoom->Velocity.Length(), *DungeonsRoom->Velocity.ToString()));
-			for (const FTransform& Door : DungeonsRoom->Doors)
+			DrawDebugBox(GetWorld(), DungeonsRoom.Location, DungeonsRoom.Extent,DungeonColor, false, TickInterval, 0, 2);
+			DrawDebugDirectionalArrow(GetWorld(), DungeonsRoom.Location, DungeonsRoom.Location + DungeonsRoom.Velocity, 10.0f, FColor::Black, false, TickInterval, 0, 2);
+			if(bIsCollapsing)
+			{
+				DrawDebugSphere(GetWorld(), DungeonsRoom.Location, DungeonsRoom.Extent.Size() + HallwayData->HallWaySectionDimensions.X, 32, FColor::Green, false, TickInterval);
+			}
+			for (const FTransform& Door : DungeonsRoom.Doors)
 			{
 				FPlane DoorPlane(Door.GetLocation(), Door.GetUnitAxis(EAxis::X));
-				DrawDebugSolidPlane(GetWorld(),DoorPlane,  Door.GetLocation(), FVector2D(HallwayData->HallWaySectionDimensions.X*0.5f, DungeonsRoom->Extent.Z), FColor::Purple, false, TickInterval);
+				DrawDebugSolidPlane(GetWorld(),DoorPlane,  Door.GetLocation(), FVector2D(HallwayData->HallWaySectionDimensions.X*0.5f, DungeonsRoom.Extent.Z), FColor::Purple, false, TickInterval);
 			}
 		}
 	}
 
 	if(bShowConnections)
 	{
-		for (const FDungeonConnection& Connection : DungeonConnections)
+		for (const FDungeonConnection& Connection : DungeonLayout.DungeonConnections)
 		{
-			DrawDebugLine(GetWorld(), Connection.StartRoom->Location, Connection.EndRoom->Location, FColor::Yellow, false, TickInterval, 0, 10);
+			DrawDebugLine(GetWorld(), DungeonNodes[Connection.StartRoom].Location, DungeonNodes[Connection.EndRoom].Location, FColor::Yellow, false, TickInterval, 0, 10);
 		}
 	}
 	if(bShowHallways)
 	{
-		for (const UDungeonHallwayData* HallWay : DungeonHallwaysData)
+		for (const FDungeonHallwaySegment& HallWay : DungeonLayout.DungeonHallways)
 		{
-			FColor* DebugColor = HallwayDebugColors.Find(HallWay->Type);
-			DrawDebugDirectionalArrow(GetWorld(), HallWay->Start, HallWay->Start + (HallWay->End - HallWay->Start)*0.5f, 1000,DebugColor ? *DebugColor : FColor::Orange, false, TickInterval, 0, 10 );
-			DrawDebugLine(GetWorld(), HallWay->Start, HallWay->End, DebugColor ? *DebugColor : FColor::Orange, false, TickInterval, 0, 10);
+			FColor* DebugColor = HallwayDebugColors.Find(HallWay.Type);
+			DrawDebugDirectionalArrow(GetWorld(), HallWay.Start, HallWay.Start + (HallWay.End - HallWay.Start)*0.5f, 1000,DebugColor ? *DebugColor : FColor::Orange, false, TickInterval, 0, 10 );
+			DrawDebugLine(GetWorld(), HallWay.Start, HallWay.End, DebugColor ? *DebugColor : FColor::Orange, false, TickInterval, 0, 10);
 		}
-		if(bIsCreatingHallways && DungeonHallwayPathFinder)
+		if(bIsCreatingHallways)
 		{
-			DungeonHallwayPathFinder->Debug(TickInterval);
+			DungeonLayout.GetHallwayPathFinder().Debug(GetWorld(), TickInterval);
 		}
 	}
 	if(bShowBounds)
 	{
-		DrawDebugBox(GetWorld(), DungeonBounds.GetCenter(), DungeonBounds.GetExtent(), FColor::Blue, false, TickInterval, 0, 2);
+		DrawDebugBox(GetWorld(), DungeonLayout.DungeonBounds.GetCenter(), DungeonLayout.DungeonBounds.GetExtent(), FColor::Blue, false, TickInterval, 0, 2);
 	}
 }
 
-void ADungeonMapper::GenerateDungeonRooms()
+bool ADungeonMapper::MakeLayoutSettings(FDungeonLayoutSettings& OutSettings) const
 {
-	SCOPE_SECONDS_ACCUMULATOR(STAT_GenerateRooms);
 	const UNavigationSystemV1* NavSys = UNavigationSystemV1::GetCurrent(GetWorld());
-	DungeonNodes.Empty(MaxRooms);
-	DungeonConnections.Empty();
-	DungeonHallwaysData.Empty();
+	if(!NavSys || !HallwayData)
+	{
+		return false;
+	}
+	OutSettings.Bounds = NavSys->GetNavigableWorldBounds();
+	
+	OutSettings.MinRooms = MinRooms;
+	OutSettings.MaxRooms = MaxRooms;
+	OutSettings.RoomXExtent = RoomXExtent;
+	OutSettings.RoomYExtent = RoomYExtent;
+	OutSettings.RoomZExtent = RoomZExtent;
+	OutSettings.RandomSeed = FRandomStream(RandomSeed).GetInitialSeed();
+	OutSettings.RoomPlacementMethod = RoomPlacementMethod;
+	OutSettings.TriangulationBackend = TriangulationBackend;
+	
+	OutSettings.MaxHallwaySlope = MaxHallwaySlope;
+	OutSettings.HallWayGenerationMethod = HallWayGenerationMethod;
+	OutSettings.HallWaySectionDimensions = HallwayData->HallWaySectionDimensions;
+	OutSettings.bPreventCrossing = bPreventCrossing;
+	OutSettings.bCreateCorners = bCreateCorners;
+	OutSettings.bHallwayToRoomConnection = bHallwayToRoomConnection;
+	OutSettings.ConnectionSimplificationMethod = ConnectionSimplificationMethod;
+	OutSettings.ExtraConnectionRatio = ExtraConnectionRatio;
+	OutSettings.SpannerStretch = SpannerStretch;
+	OutSettings.MaxPathFinderIterations = MaxPathFinderIterations;
+	
+	OutSettings.SpringConstant = SpringConstant;
+	OutSettings.SpringForcePreservation = SpringForcePreservation;
+	OutSettings.bApplyNodeRepulsion = bApplyNodeRepulsion;
+	OutSettings.bApplySpringForce = bApplySpringForce;
+	return true;
+}
+
+void ADungeonMapper::GenerateDungeonRooms()
+{
 	for (ADungeonRoom* DungeonRoom : DungeonRooms)
 	{
 		DungeonRoom->Destroy();
 	}
 	DungeonRooms.Empty();
-	if(!NavSys)
-	{
-		return;
-	}
-	DungeonBounds = NavSys->GetNavigableWorldBounds();
-
-	//Divde spawn area in equal spaced cells of max size of rooms
-	const int32 XCells = DungeonBounds.GetExtent().X / (RoomXExtent.Y);
-	const int32 YCells = DungeonBounds.GetExtent().Y / (RoomYExtent.Y);
-	const int32 ZCells = DungeonBounds.GetExtent().Z / (RoomZExtent.Y);
-
-	FBox CellBounds(FVector::ZeroVector, FVector::ZeroVector);
-	CellBounds = CellBounds.ExpandBy(FVector(DungeonBounds.GetExtent().X / XCells,  DungeonBounds.GetExtent().Y / YCells, DungeonBounds.GetExtent().Z / ZCells));
-	const FVector CellStartingLocation = DungeonBounds.Min - CellBounds.Min;
-
-	FRandomStream RandomStream(RandomSeed);
-	FVector MinDungeonBounds = FVector::ZeroVector;
-	FVector MaxDungeonBounds = FVector::ZeroVector;
+	bIsCollapsing = false;
+	bIsCreatingHallways = false;
 	
-	const int32 RoomsToGenerate = RandomStream.RandRange(FMath::Min(MinRooms,XCells * YCells * ZCells) , FMath::Min(MaxRooms,XCells * YCells * ZCells));
-	TArray<FVector> UsedUpCells;
-	for(int32 i = 0; i < RoomsToGenerate; i++)
+	if(!MakeLayoutSettings(DungeonLayout.Settings))
 	{
-		// Randomise the size of the room, and in what cell we want to spawn it.
-		// reduce the bounds of the cell by the size of the room, so we are sure the room won't go outside the spawn area.
-		// randomise a location in the narrowed down Cell bounds.
-		const FVector CellExtend = CellBounds.GetExtent()*2.0f;
-		
-		const int32 RoomXSize = RandomStream.RandRange(RoomXExtent.X, RoomXExtent.Y);
-		const int32 RoomYSize = RandomStream.RandRange(RoomYExtent.X, RoomYExtent.Y);
-		const int32 RoomZSize = RandomStream.RandRange(RoomZExtent.X, RoomZExtent.Y);
-		const FVector RoomSize(RoomXSize, RoomYSize, RoomZSize);
-
-		//Make sure we dont use a cell already with a room
-		FVector CellCoord = FVector::ZeroVector;
-		do
-		{
-			const int32 XCell = RandomStream.RandRange(0, XCells - 1);
-			const int32 YCell = RandomStream.RandRange(0, YCells - 1);
-			const int32 ZCell = RandomStream.RandRange(0, ZCells - 1);
-			CellCoord = FVector(XCell, YCell, ZCell);
-			
-		}while(UsedUpCells.Contains(CellCoord));
-		
-		UsedUpCells.Add(CellCoord);
-		
-		const float XPosition = CellCoord.X*CellExtend.X+CellStartingLocation.X;
-		const float YPosition = CellCoord.Y*CellExtend.Y+CellStartingLocation.Y;
-		const float ZPosition = CellCoord.Z*CellExtend.Z+CellStartingLocation.Z;
-
-		FBox SpawnerCellBounds = CellBounds.ExpandBy( -FVector(RoomXSize, RoomYSize ,RoomZSize));
-		SpawnerCellBounds = SpawnerCellBounds.MoveTo(FVector(XPosition, YPosition, ZPosition));
-	
-		const FVector RoomLocation = RandomStream.RandPointInBox(SpawnerCellBounds);
-
-		UDungeonRoomData* NewRoom = DuplicateObject(RoomData, this);
-		NewRoom->Location = RoomLocation;
-		NewRoom->Extent = RoomSize;
-				
-		DungeonNodes.Add(NewRoom);
-		
-		FVector RoomMin = RoomLocation - RoomSize;
-		FVector RoomMax = RoomLocation + RoomSize;
-
-		if(i==0)
-		{
-			MinDungeonBounds = RoomMin;
-			MaxDungeonBounds = RoomMax;
-		}
-		else
-		{
-			MinDungeonBounds.X = FMath::Min(RoomMin.X, MinDungeonBounds.X);
-			MinDungeonBounds.Y = FMath::Min(RoomMin.Y, MinDungeonBounds.Y);
-			MinDungeonBounds.Z = FMath::Min(RoomMin.Z, MinDungeonBounds.Z);
-
-			MaxDungeonBounds.X = FMath::Max(RoomMax.X, MaxDungeonBounds.X);
-			MaxDungeonBounds.Y = FMath::Max(RoomMax.Y, MaxDungeonBounds.Y);
-			MaxDungeonBounds.Z = FMath::Max(RoomMax.Z, MaxDungeonBounds.Z);
-		}
+		DungeonLayout.Reset();
+		return;
 	}
-	DungeonBounds = FBox(MinDungeonBounds, MaxDungeonBounds);
+	DungeonLayout.GenerateRooms();
 }
 
 void ADungeonMapper::ConnectRooms()
 {
-	SCOPE_SECONDS_ACCUMULATOR(STAT_ConnectRooms);
-	DungeonConnections.Empty();
-	DungeonHallwaysData.Empty();
-	TArray<FTetrahedron> Tetrahedrons;
-	if(DungeonNodes.IsEmpty())
+	if(!MakeLayoutSettings(DungeonLayout.Settings))
 	{
 		return;
 	}
-	
-	//Generate a big enough tetra so that it engulf all vertex(rooms) ************************************************//
-	float minX = DungeonNodes[0]->Location.X;
-	float minY = DungeonNodes[0]->Location.Y;
-	float minZ = DungeonNodes[0]->Location.Z;
-	float maxX = minX;
-	float maxY = minY;
-	float maxZ = minZ;
-
-	for (const UDungeonRoomData* Room : DungeonNodes) {
-		if (Room->Location.X < minX) minX = Room->Location.X;
-		if (Room->Location.X > maxX) maxX = Room->Location.X;
-		if (Room->Location.Y < minY) minY = Room->Location.Y;
-		if (Room->Location.Y > maxY) maxY = Room->Location.Y;
-		if (Room->Location.Z < minZ) minZ = Room->Location.Z;
-		if (Room->Location.Z > maxZ) maxZ = Room->Location.Z;
-	}
-
-	float dx = maxX - minX;
-	float dy = maxY - minY;
-	float dz = maxZ - minZ;
-	float deltaMax = FMath::Max3(dx, dy, dz) * 2;
-	
-	const FVector V1 = FVector(minX - 1, minY - 1, minZ - 1);
-	const FVector V2 = FVector(maxX + deltaMax, minY - 1, minZ - 1);
-	const FVector V3 =  FVector(minX - 1, maxY + deltaMax, minZ - 1);
-	const FVector V4 = FVector(minX - 1, minY - 1, maxZ + deltaMax);
-
-	UDungeonRoomData* DummyRoom1 = DuplicateObject(RoomData, this);
-	DummyRoom1->Location = V1;
-	DummyRoom1->Extent = FVector::ZeroVector;
-	DummyRoom1->RoomType = ERoomType::Dummy;
-	
-	UDungeonRoomData* DummyRoom2 = DuplicateObject(RoomData, this);
-	DummyRoom2->Location = V2;
-	DummyRoom2->Extent = FVector::ZeroVector;
-	DummyRoom2->RoomType = ERoomType::Dummy;
-	
-	UDungeonRoomData* DummyRoom3 = DuplicateObject(RoomData, this);
-	DummyRoom3->Location = V3;
-	DummyRoom3->Extent = FVector::ZeroVector;
-	DummyRoom3->RoomType = ERoomType::Dummy;
-	
-	UDungeonRoomData* DummyRoom4 = DuplicateObject(RoomData, this);
-	DummyRoom4->Location = V4;
-	DummyRoom4->Extent = FVector::ZeroVector;
-	DummyRoom4->RoomType = ERoomType::Dummy;
-	
-	Tetrahedrons.Add(FTetrahedron(DummyRoom1, DummyRoom2, DummyRoom3, DummyRoom4));
-	//****************************************************************************************************************//
-	
-	for (UDungeonRoomData* DungeonsNode : DungeonNodes)
-	{
-		EvaluateVertex(DungeonsNode, Tetrahedrons);
-	}
-	
-	GenerateConnectionFromTetras(Tetrahedrons);
+	DungeonLayout.ConnectRooms();
 }
 
 void ADungeonMapper::SimplifyConnections()
 {
-	if(DungeonNodes.IsEmpty())
+	if(!MakeLayoutSettings(DungeonLayout.Settings))
 	{
 		return;
 	}
-	SCOPE_SECONDS_ACCUMULATOR(STAT_SimplifyConections);
-	//To simplify the hallways generated by the Delauney algo we are going to path from a fixed room to all other and
-	//removing all edges not used in any path
-	UDungeonRoomData** StartingRoom = DungeonNodes.FindByPredicate([](const UDungeonRoomData* Room){ return Room->RoomType == ERoomType::Starting;});
-	FRandomStream RandomStream(RandomSeed);
-	if(!StartingRoom)
-	{
-		const int32 StartingRoomIdx = RandomStream.RandRange(0, DungeonNodes.Num() - 1);
-		StartingRoom = &DungeonNodes[StartingRoomIdx];
-		(*StartingRoom)->RoomType = ERoomType::Starting;
-	}
-		
-	TArray<UDungeonRoomData*> PathedRooms;
-	TArray<FDungeonPath> Paths;
-	PathedRooms.Add(*StartingRoom);
-
-	
-	for (int RoomIdx = 0; RoomIdx < DungeonNodes.Num(); ++RoomIdx)
-	{
-		UDungeonRoomData* RoomToPath = DungeonNodes[RoomIdx];
-		if(PathedRooms.Contains(RoomToPath))
-		{
-			continue;
-		}
-		FDungeonPath NewPath;
-		NewPath.Start = *StartingRoom;
-		NewPath.End = RoomToPath;
-		
-		//Start Pathing
-		TArray<FPathNode> OpenRooms;
-		TArray<FPathNode> ClosedRooms;
-		OpenRooms.Add(*StartingRoom);
-		
-		while (!OpenRooms.IsEmpty())
-		{
-			FPathNode CurrentRoom = OpenRooms.Pop();
-			ClosedRooms.Add(CurrentRoom.Room);
-
-			if(CurrentRoom.Room == RoomToPath)
-			{
-				NewPath.AssignPath(CurrentRoom.Path);
-				Paths.Add(NewPath);
-				break;
-			}
-
-			TArray<FPathNode> ConnectedRooms;
-			for (const FDungeonConnection* HallWay : CurrentRoom.Room->Connections)
-			{
-				ConnectedRooms.Add(FPathNode(CurrentRoom, HallWay));
-			}
-
-			for (FPathNode& Room : ConnectedRooms)
-			{
-				if(ClosedRooms.Contains(Room))
-				{
-					continue;
-				}
-
-				Room.G = CurrentRoom.G + FVector::DistSquared(CurrentRoom.Room->Location, Room.Room->Location);
-				Room.H = FVector::DistSquared(RoomToPath->Location, Room.Room->Location);
-				Room.F = Room.G + Room.H;
-
-				int32 RoomIndex = OpenRooms.Find(Room);
-				if(RoomIndex != INDEX_NONE && Room < OpenRooms[RoomIndex])
-				{
-					continue;
-				}
-				
-				OpenRooms.Push(Room);
-			}
-			OpenRooms.Sort();
-		}
-		PathedRooms.Add(RoomToPath);
-	}
-
-	//if you whant to keep some hallways even if they are not used in any path jus add the conditions below
-	//EG: Randomize when returning true to have a chance to not remove the hallway.
-	DungeonConnections.RemoveAll([&Paths](const FDungeonConnection& HallWay)
-	{
-		for (const FDungeonPath& Path : Paths)
-		{
-			for (const FDungeonConnection* PathHallway : Path.Path)
-			{
-				const bool StartRoomDup = PathHallway->StartRoom == HallWay.StartRoom || PathHallway->StartRoom == HallWay.EndRoom;
-				const bool EndRoomDup = PathHallway->EndRoom == HallWay.StartRoom || PathHallway->EndRoom == HallWay.EndRoom;
-				if(StartRoomDup && EndRoomDup)
-				{
-					return false;
-				}
-			}
-		}
-		return true;
-	});
-
-	for (UDungeonRoomData* DungeonsRoom : DungeonNodes)
-	{
-		DungeonsRoom->Connections.Empty();
-	}
-
-	for (const FDungeonConnection& Connection : DungeonConnections)
-	{
-		Connection.StartRoom->Connections.Add(&Connection);
-		Connection.EndRoom->Connections.Add(&Connection);
-	}
-	
-	//Marking the room at the end of the longest path as the boss room
-	UDungeonRoomData* FurthestRoom = *StartingRoom;
-	float FurthestDistance = 0;
-	
-	for (const FDungeonPath& Path : Paths)
-	{
-		if(Path.DistanceTraveled > FurthestDistance)
-		{
-			FurthestDistance = Path.DistanceTraveled;
-			FurthestRoom = Path.End;
-		}
-	}
-	FurthestRoom->RoomType = ERoomType::End;
+	DungeonLayout.SimplifyConnections();
 }
 
 void ADungeonMapper::Collapse()
 {
-	bIsCollapsing = true;
-	CollapsingIterationNotModified = 0;
-}
-
-UDungeonHallwayData* ADungeonMapper::CreateConnectionFromEdgePoint(UDungeonRoomData* ConnectedRoom, FVector Start, FVector End)
-{
-	if(!bHallwayToRoomConnection)
+	if(!MakeLayoutSettings(DungeonLayout.Settings))
 	{
-		return nullptr;
-	}
-	FTransform StartDoorTransform;
-	const FRotator StartRoomDoorRotation = (End - Start).Rotation();
-	StartDoorTransform = FTransform(StartRoomDoorRotation, Start);
-	ConnectedRoom->Doors.Add(StartDoorTransform);
-	if(FVector::Distance(End, Start) >= HallwayData->HallWaySectionDimensions.X)
-	{//Create Start door connection hallway
-		UDungeonHallwayData* NewHallway = DuplicateObject(HallwayData, this);
-		NewHallway->Direction = StartDoorTransform.GetUnitAxis(EAxis::X);
-		NewHallway->Start = StartDoorTransform.GetLocation();
-		NewHallway->End = NewHallway->Start + NewHallway->Direction * (NewHallway->HallWaySectionDimensions.X * 0.5f);
-		const bool IsVerticalCorridor = NewHallway->Direction.GetAbs().Equals(FVector::UpVector);
-		NewHallway->Type = IsVerticalCorridor ? ECorridorType::VRoomConnection : ECorridorType::HRoomConnection;
-		return NewHallway;
+		return;
 	}
-	return nullptr;
+	DungeonLayout.BeginCollapse();
+	bIsCollapsing = true;
 }
 
 void ADungeonMapper::CreateHallways()
 {
-	DungeonHallwaysData.Empty();
-	bIsCreatingHallways = true;
-	ConnectionID = 0;
-	if(DungeonConnections.IsEmpty())
+	if(!MakeLayoutSettings(DungeonLayout.Settings))
 	{
 		return;
 	}
-
-	if(HallWayGenerationMethod == EHallwayGenerationMethod::PathFinding)
+	if(HallwayFrameBudgetMs > 0.0f)
 	{
-		DungeonHallwayPathFinder->PathStartLocation = DungeonConnections[ConnectionID].StartRoom->Location;
-		DungeonHallwayPathFinder->StartRoomExtent = DungeonConnections[ConnectionID].StartRoom->Extent;
-		DungeonHallwayPathFinder->EndRoomExtent = DungeonConnections[ConnectionID].EndRoom->Extent;
-		DungeonHallwayPathFinder->MaxSlopeAngle = MaxHallwaySlope;
-		DungeonHallwayPathFinder->HallWaySegmentLength = HallwayData->HallWaySectionDimensions.X;
-		DungeonHallwayPathFinder->FillAdditionalValidConnectionDirections(DungeonConnections[ConnectionID].StartRoom->Location, DungeonConnections[ConnectionID].EndRoom->Location);
-		DungeonHallwayPathFinder->Initialize(DungeonConnections[ConnectionID].StartRoom->Location, DungeonConnections[ConnectionID].EndRoom->Location);
+		//Paths are found on the game thread a bit every Tick, see RunHallwaysCreation
+		DungeonLayout.BeginHallwaysCreation();
+		bIsCreatingHallways = DungeonLayout.IsCreatingHallways();
 		return;
 	}
-	
-	//creating hallways based on room connections
-	for (const FDungeonConnection& Connection : DungeonConnections)
-	{
-		///Divide conection into segments based on vector components///
-		const FVector ConnectionStart = Connection.StartRoom->Location;
-		const FVector ConnectionEnd = Connection.EndRoom->Location;
-		FVector ConnectionComponents[4];
-		ConnectionComponents[0] = ConnectionStart;
-		ConnectionComponents[3] = ConnectionEnd;
-		
-		{
-			float ShortestDistanceToEndConnection = MAX_FLT;
-			for (int i = 0; i < 4; ++i)
-			{
-				FVector ExitPoint = ConnectionStart + DungeonHallwayPathFinder->CoreValidConnectionDirection[i] * (Connection.StartRoom->Extent);
-				// float Distance2DToEndConnection = FVector::DistSquared2D(ExitPoint, ConnectionEnd);
-				// if(Distance2DToEndConnection < HallwayData->HallWaySectionDimensions.X*HallwayData->HallWaySectionDimensions.X)
-				// {
-				// 	continue;
-				// }
-				float DistanceToEndConnection = FVector::DistSquared(ExitPoint, ConnectionEnd);
-				
-				if(DistanceToEndConnection < ShortestDistanceToEndConnection)
-				{
-					ShortestDistanceToEndConnection = DistanceToEndConnection;
-					ConnectionComponents[1] = DungeonHallwayPathFinder->CoreValidConnectionDirection[i];
-				}
-			}
-		}
-	
-		ConnectionComponents[0] = ConnectionStart + ConnectionComponents[1] * (Connection.StartRoom->Extent);
-		
-		{
-			float ShortestDistanceToEndConnection = MAX_FLT;
-			for (int i = 0; i < 4; ++i)
-			{
-				FVector EExitPoint = ConnectionEnd + DungeonHallwayPathFinder->CoreValidConnectionDirection[i] * (Connection.EndRoom->Extent);
-				FVector StartToEnd = EExitPoint - ConnectionComponents[0];
-				FVector SHallwaySegment = ConnectionComponents[0] + ConnectionComponents[1] *  StartToEnd * 0.5f;
-				FPlane Plane(ConnectionComponents[1],ConnectionComponents[0] + SHallwaySegment);
-				FVector InterectionPoint;
-				bool Interect = FMath::SegmentPlaneIntersection(EExitPoint, EExitPoint + DungeonHallwayPathFinder->CoreValidConnectionDirection[i] * (Connection.EndRoom->Extent), Plane, InterectionPoint);
-				if(Interect)
-				{
-					continue;
-				}
-				FVector ExitPoint = ConnectionEnd + DungeonHallwayPathFinder->CoreValidConnectionDirection[i] * (Connection.EndRoom->Extent);
-				float DistanceToEndConnection = FVector::DistSquared(ExitPoint, ConnectionComponents[0]);
-				if(DistanceToEndConnection < ShortestDistanceToEndConnection)
-				{
-					ShortestDistanceToEndConnection = DistanceToEndConnection;
-					ConnectionComponents[2] = DungeonHallwayPathFinder->CoreValidConnectionDirection[i];
-				}
-			}
-		}
-	
-		
-		ConnectionComponents[3] = ConnectionEnd + ConnectionComponents[2] * (Connection.EndRoom->Extent);
-	
-		FVector StartToEnd = ConnectionComponents[3] - ConnectionComponents[0];
-		ConnectionComponents[1] = ConnectionComponents[0] + ConnectionComponents[1] *  StartToEnd.GetAbs() * 0.5f;
-		ConnectionComponents[2] = ConnectionComponents[3] + ConnectionComponents[2] *  StartToEnd.GetAbs() * 0.5f;
-	
-		const FVector Slope = ConnectionComponents[2] - ConnectionComponents[1];
-		const FVector SlopeDirection = Slope.GetSafeNormal();
-		FVector SlopeBase = Slope;
-		SlopeBase.Z = 0.f;
-		SlopeBase.Normalize();
-		float Dot = FVector::DotProduct(SlopeDirection, SlopeBase);
-		float SlopeAngle = FMath::RadiansToDegrees(FMath::Acos(Dot));
-		if(SlopeAngle > MaxHallwaySlope)
-		{
-			float TanAngl = FMath::Tan(FMath::DegreesToRadians(MaxHallwaySlope));
-			float Adjacent = Slope.Z/TanAngl;
-			Adjacent*=0.5f;
-			FVector Direction = ConnectionComponents[3] -  ConnectionComponents[2];
-			ConnectionComponents[2] = ConnectionComponents[3] - Direction.GetSafeNormal()*(Direction.Length() - Adjacent);
-			Direction = ConnectionComponents[1] -  ConnectionComponents[0];
-			ConnectionComponents[1] = ConnectionComponents[0] + Direction.GetSafeNormal()*(Direction.Length() - Adjacent);
-		}
-		/////////////////////////////////////////////////////////////
-		
-		///Create the doors info for the hallway, and the star and end connector to the respective rooms ////
-		FVector Start = ConnectionComponents[0];
-		FVector End = ConnectionComponents[1];
-		UDungeonHallwayData* NewHallwayConnection = CreateConnectionFromEdgePoint(Connection.StartRoom, Start, End);
-		if(NewHallwayConnection)
-		{
-			DungeonHallwaysData.AddUnique(NewHallwayConnection);
-		}
-		
-		Start =  ConnectionComponents[3];
-		End = ConnectionComponents[2];
-		NewHallwayConnection = CreateConnectionFromEdgePoint(Connection.EndRoom, Start, End);
-		if(NewHallwayConnection)
-		{
-			DungeonHallwaysData.AddUnique(NewHallwayConnection);
-		}
-		////////////////////////////////////////////////////////////
-	
-		/// create the hallway data from the conneciton components
-		for (int i = 0; i < 3; ++i)
-		{
-			if(ConnectionComponents[i].Equals(ConnectionComponents[i + 1]))
-			{
-				continue;
-			}
-			
-			UDungeonHallwayData* NewHallway = DuplicateObject(HallwayData, this);
-			NewHallway->Start = ConnectionComponents[i];
-			NewHallway->End = ConnectionComponents[i + 1];
-			NewHallway->Direction = (NewHallway->End - NewHallway->Start).GetSafeNormal();
-			const bool IsStairs = (NewHallway->End.Z - NewHallway->Start.Z) != 0;
-			NewHallway->Type = IsStairs ? ECorridorType::Stairs : ECorridorType::HStraight;
-			
-			DungeonHallwaysData.AddUnique(NewHallway);
-		}
-		////////////////////////////////////////////////////////////
-	}
-	
-	// some hallways might go through dungeon rooms, so we should split them to prevent this
-	if(bPreventCrossing)
-	{
-		TArray< UDungeonHallwayData*> NewHallways;
-		for (UDungeonHallwayData* HallWay : DungeonHallwaysData)
-		{
-			for (UDungeonRoomData* Room : DungeonNodes)
-			{
-					UDungeonHallwayData* NewHallway = FixHallwayCrossingRoom(Room,  HallWay->Start, HallWay->End);
-					if(NewHallway)
-					{
-						NewHallways.AddUnique(NewHallway);
-						HallWay->bIsInvalid = true;
-	
-						UDungeonHallwayData* NewHallwayConnection = CreateConnectionFromEdgePoint(Room, NewHallway->End, NewHallway->Start);
-						if(NewHallwayConnection)
-						{
-							NewHallways.AddUnique(NewHallwayConnection);
-						}
-					}
-	
-					NewHallway = FixHallwayCrossingRoom(Room,  HallWay->End, HallWay->Start);
-					if(NewHallway)
-					{
-						NewHallways.AddUnique(NewHallway);
-						HallWay->bIsInvalid = true;
-	
-						UDungeonHallwayData* NewHallwayConnection = CreateConnectionFromEdgePoint(Room,NewHallway->End, NewHallway->Start);
-						if(NewHallwayConnection)
-						{
-							NewHallways.AddUnique(NewHallwayConnection);
-						}
-					}
-				}
-		}
-	
-		
-		DungeonHallwaysData.RemoveAll([](const UDungeonHallwayData* OtherHallWay)
-			{
-				return OtherHallWay->bIsInvalid;
-			});
-		DungeonHallwaysData.Append(NewHallways);
-	}
-	
-	//Merge Hallways that fallow the same path
-	int32 NumHallways = DungeonHallwaysData.Num();
-	for (int i = 0; i < NumHallways; ++i)
-	{
-		UDungeonHallwayData* FirstHallway = DungeonHallwaysData[i];
-		if(FirstHallway->Type != ECorridorType::HStraight && FirstHallway->Type != ECorridorType::Stairs)
-		{
-			continue;
-		}
-		for (int j = i + 1; j < NumHallways; ++j)
-		{
-			UDungeonHallwayData* SecondHallway = DungeonHallwaysData[j];
-			if(SecondHallway->Type != ECorridorType::HStraight && SecondHallway->Type != ECorridorType::Stairs)
-			{
-				continue;
-			}
-	
-	
-			bool AreColinear = FirstHallway->Direction.GetAbs().Equals(SecondHallway->Direction.GetAbs());
-			if(!AreColinear)
-			{
-				continue;
-			}
-			
-			const FVector FirstInvertedDirection(!FirstHallway->Direction.X,!FirstHallway->Direction.Y, !FirstHallway->Direction.Z);
-			const FVector SecondInvertedDirection(!SecondHallway->Direction.X,!SecondHallway->Direction.Y, !SecondHallway->Direction.Z);
-			const FVector FirstNegatedStart = FirstHallway->Start*FirstInvertedDirection;
-			const FVector SecondNegatedStart = SecondHallway->Start*SecondInvertedDirection;
-			if(!FirstNegatedStart.Equals(SecondNegatedStart))
-			{
-				continue;
-			}
-	
-			if(FirstHallway->Direction.Equals(SecondHallway->Direction))
-			{
-				if(FirstHallway->Start.Equals(SecondHallway->End))
-				{
-					FirstHallway->Start = SecondHallway->Start;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->End.Equals(SecondHallway->Start))
-				{
-					FirstHallway->End = SecondHallway->End;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->Start.Equals(SecondHallway->Start) || FirstHallway->End.Equals(SecondHallway->End))
-				{
-					if(FVector::Dist(FirstHallway->Start, FirstHallway->End) > FVector::Dist(SecondHallway->Start, SecondHallway->End))
-					{
-						SecondHallway->bIsInvalid = true;
-					}
-					else
-					{
-						FirstHallway->bIsInvalid = true;
-					}
-				}
-			}
-			else
-			{
-				if(FirstHallway->Start.Equals(SecondHallway->Start))
-				{
-					FirstHallway->Start = SecondHallway->End;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->End.Equals(SecondHallway->End))
-				{
-					FirstHallway->End = SecondHallway->Start;
-					SecondHallway->bIsInvalid = true;
-				}
-				else if(FirstHallway->Start.Equals(SecondHallway->End) || FirstHallway->End.Equals(SecondHallway->Start))
-				{
-					if(FVector::Dist(FirstHallway->Start, FirstHallway->End) > FVector::Dist(SecondHallway->Start, SecondHallway->End))
-					{
-						SecondHallway->bIsInvalid = true;
-					}
-					else
-					{
-						FirstHallway->bIsInvalid = true;
-					}
-				}
-			}
-		}
-	}
-	
-	DungeonHallwaysData.RemoveAll([](const UDungeonHallwayData* OtherHallWay)
-		{
-			return OtherHallWay->bIsInvalid;
-		});
-	
-	if(bCreateCorners)
-	{
-		/// Create Corner sections of hallways
-	 	NumHallways = DungeonHallwaysData.Num();
-	 	for (int i = 0; i < NumHallways; ++i)
-	 	{
-	 		UDungeonHallwayData* FirstHallway = DungeonHallwaysData[i];
-	 		if(FirstHallway->Type != ECorridorType::HStraight && FirstHallway->Type != ECorridorType::Stairs)
-	 		{
-	 			continue;
-	 		}
-	 		for (int j = i + 1; j < NumHallways; ++j)
-	 		{
-	 			UDungeonHallwayData* SecondHallway = DungeonHallwaysData[j];
-	 			if(SecondHallway->Type != ECorridorType::HStraight && SecondHallway->Type != ECorridorType::Stairs)
-	 			{
-	 				continue;
-	 			}
-	
-	 			FVector IntersectionPoint1 = FVector::ZeroVector;
-	 			FVector IntersectionPoint2 = FVector::ZeroVector;
-	 			FMath::SegmentDistToSegmentSafe(FirstHallway->Start, FirstHallway->End, SecondHallway->Start, SecondHallway->End, IntersectionPoint1, IntersectionPoint2);
-	 			bool bIntersect = IntersectionPoint1.Equals(IntersectionPoint2);
-	 			if(bIntersect)
-	 			{
-	 				
-	 				FVector CornerStart;
-	 				FVector CornerPoint = IntersectionPoint1;
-	 				FVector CornerEnd;
-	 				if(FirstHallway->End.Equals(CornerPoint))
-	 				{
-	 					CornerStart = FirstHallway->Start;
-	 					CornerEnd = SecondHallway->End;
-	 				}
-	 				else if(FirstHallway->Start.Equals(CornerPoint))
-	 				{
-	 					CornerStart = SecondHallway->Start;
-	 					CornerEnd = FirstHallway->End;
-	 				}
-	 				else if(SecondHallway->End.Equals(CornerPoint))
-	 				{
-	 					CornerStart = SecondHallway->Start;
-	 					CornerEnd = FirstHallway->End;
-	 				}
-	 				else if(SecondHallway->Start.Equals(CornerPoint))
-	 				{
-	 					CornerStart = FirstHallway->Start;
-	 					CornerEnd = SecondHallway->End;
-	 				}
-				    else
-				    {
-					    continue;
-				    }
-	 				
-	 				FVector HallwayDirection = (CornerPoint - CornerStart).GetSafeNormal();
-	 			
-	 				UDungeonHallwayData* NewCorner = DuplicateObject(HallwayData, this);
-	 				NewCorner->Start = CornerPoint - HallwayDirection * NewCorner->HallWaySectionDimensions.X;
-	 				NewCorner->End = CornerPoint + (CornerEnd - CornerPoint).GetSafeNormal() * NewCorner->HallWaySectionDimensions.X;
-	 				NewCorner->Direction = HallwayDirection;
-	 				const bool IsStairs = (NewCorner->End.Z - NewCorner->Start.Z) != 0;
-	 				NewCorner->Type = IsStairs ? ECorridorType::StairConnection : ECorridorType::HCorner;
-	 				DungeonHallwaysData.AddUnique(NewCorner);
-	 				
-	 			}
-	 		}
-	 	}
-	}	
+	DungeonLayout.CreateHallways();
+	bIsCreatingHallways = false;
 }
 
 void ADungeonMapper::RenderDungeon()
 {
-	SCOPE_SECONDS_ACCUMULATOR(STAT_RenderDungeon);
+	SCOPE_DUNGEON_STAT(STAT_RenderDungeon);
+	SET_DWORD_STAT(STAT_BooleanOperations, 0);
 	UDynamicMesh* MainDynMesh = DynamicMeshComponent->GetDynamicMesh();
 	MainDynMesh->Reset();
 	// FGeometryScriptSetSimpleCollisionOptions Options;
@@ -1169,19 +328,19 @@ void ADungeonMapper::RenderDungeon()
 	UWorld* World = GetWorld();
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.Owner = this;
-	for (UDungeonRoomData* DungeonNode : DungeonNodes)
+	for (const FDungeonNode& DungeonNode : DungeonLayout.DungeonNodes)
 	{
-		ADungeonRoom* NewRoom = World->SpawnActor<ADungeonRoom>(ADungeonRoom::StaticClass(), DungeonNode->Location,FRotator::ZeroRotator, SpawnParams);
-		NewRoom->InitializeRoom(DungeonNode);
+		ADungeonRoom* NewRoom = World->SpawnActor<ADungeonRoom>(ADungeonRoom::StaticClass(), DungeonNode.Location,FRotator::ZeroRotator, SpawnParams);
+		NewRoom->InitializeRoom(DungeonNode, RoomData);
 		DungeonRooms.Add(NewRoom);
 	}
 	
-	for (const UDungeonHallwayData* DungeonHallway : DungeonHallwaysData)
+	for (const FDungeonHallwaySegment& DungeonHallway : DungeonLayout.DungeonHallways)
 	{
 		RenderHallWays(MainDynMesh, DungeonHallway);
 	}
 		
-	// for (const UDungeonHallwayData* DungeonHallway : DungeonHallwaysData)
+	// for (const FDungeonHallwaySegment& DungeonHallway : DungeonLayout.DungeonHallways)
 	// {
 	// 	HallowHallWays(MainDynMesh, DungeonHallway);
 	// }
@@ -1190,16 +349,21 @@ void ADungeonMapper::RenderDungeon()
 	bool bHasMerged = false;
 	
 	//UGeometryScriptLibrary_CollisionFunctions::SetSimpleCollisionOfDynamicMeshComponent(DungeonCollision, DynamicMeshComponent, Options);
-	
+	SET_DWORD_STAT(STAT_TriangleCount, GetRenderedTriangleCount());
 }
 
 void ADungeonMapper::ClearAll()
 {
 	UDynamicMesh* DynMesh = DynamicMeshComponent->GetDynamicMesh();
 	DynMesh->Reset();
-	DungeonConnections.Empty();
-	DungeonHallwaysData.Empty();
-	DungeonNodes.Empty();
+	DungeonLayout.Reset();
+	bIsCollapsing = false;
+	bIsCreatingHallways = false;
+	if(bIsGeneratingAsync)
+	{
+		bIsGeneratingAsync = false;
+		OnDungeonGenerated.Broadcast(this, false);
+	}
 	for (ADungeonRoom* DungeonRoom : DungeonRooms)
 	{
 		DungeonRoom->Destroy();
@@ -1208,7 +372,26 @@ void ADungeonMapper::ClearAll()
 	SET_FLOAT_STAT(STAT_GenerateRooms, 0.0f);
 	SET_FLOAT_STAT(STAT_ConnectRooms, 0.0f);
 	SET_FLOAT_STAT(STAT_SimplifyConections, 0.0f);
+	SET_FLOAT_STAT(STAT_Collapse, 0.0f);
+	SET_FLOAT_STAT(STAT_CreateHallways, 0.0f);
+	SET_FLOAT_STAT(STAT_CreateHallwaysFromPath, 0.0f);
+	SET_FLOAT_STAT(STAT_FinishHallways, 0.0f);
+	SET_FLOAT_STAT(STAT_PathFinderEvaluate, 0.0f);
 	SET_FLOAT_STAT(STAT_RenderDungeon, 0.0f);
+	SET_FLOAT_STAT(STAT_RenderHallways, 0.0f);
+	SET_FLOAT_STAT(STAT_InitializeRoom, 0.0f);
+	SET_FLOAT_STAT(STAT_CreateDoors, 0.0f);
+	SET_FLOAT_STAT(STAT_AppendHallowedBox, 0.0f);
+	SET_FLOAT_STAT(STAT_AppendHallwayCorner, 0.0f);
+	SET_FLOAT_STAT(STAT_AppendHallway, 0.0f);
+	SET_DWORD_STAT(STAT_RoomCount, 0);
+	SET_DWORD_STAT(STAT_TetrahedronCount, 0);
+	SET_DWORD_STAT(STAT_ConnectionCount, 0);
+	SET_DWORD_STAT(STAT_HallwaySegmentCount, 0);
+	SET_DWORD_STAT(STAT_PathFinderOpenNodes, 0);
+	SET_DWORD_STAT(STAT_PathFinderClosedNodes, 0);
+	SET_DWORD_STAT(STAT_BooleanOperations, 0);
+	SET_DWORD_STAT(STAT_TriangleCount, 0);
 }
 
 void ADungeonMapper::NextStep()
@@ -1216,180 +399,34 @@ void ADungeonMapper::NextStep()
 	FlushPersistentDebugLines(GetWorld());
 }
 
-void ADungeonMapper::EvaluateVertex(UDungeonRoomData* Vertex, TArray<FTetrahedron>& OutTetrahedrons) const
-{
-	SCOPE_SECONDS_ACCUMULATOR(STAT_ConnectRooms);
-	TArray<FTriangle> Triangles;
-	Triangles.Reserve(OutTetrahedrons.Num() * 4);
-	
-	for (FTetrahedron& Tetra : OutTetrahedrons)
-	{
-		// if vert falls inside cirmushpere then this tetra is invalid
-		//we break it up into its triangles
-		if(Tetra.CircumSphereContains(Vertex))
-		{
-			Tetra.bIsBad = true;
-			Triangles.Add(FTriangle(Tetra.Vert1, Tetra.Vert2, Tetra.Vert3));
-			Triangles.Add(FTriangle(Tetra.Vert1, Tetra.Vert2, Tetra.Vert4));
-			Triangles.Add(FTriangle(Tetra.Vert1, Tetra.Vert3, Tetra.Vert4));
-			Triangles.Add(FTriangle(Tetra.Vert2, Tetra.Vert3, Tetra.Vert4));
-		}
-	}
-
-	//we mark as invalid triangles any duplicates
-	for (int i = 0; i < Triangles.Num(); ++i)
-	{
-		for (int j = i + 1; j < Triangles.Num(); ++j)
-		{
-			if(FTriangle::AlmostEqual(Triangles[i], Triangles[j]))
-			{
-				Triangles[i].bIsBad = true;
-				Triangles[j].bIsBad = true;
-			}
-		}
-	}
-
-	OutTetrahedrons.RemoveAll([](const FTetrahedron& Tetra)
-	{
-		return Tetra.bIsBad;
-	});
-	Triangles.RemoveAll([](const FTriangle& Triangle)
-	{
-		return Triangle.bIsBad;
-	});
-
-	//generate new tetrahedrons from remaining triangles and new vertex
-	for (const FTriangle& Triangle : Triangles)
-	{
-		FTetrahedron NewTetra(Triangle.Vert1, Triangle.Vert2, Triangle.Vert3, Vertex);
-		OutTetrahedrons.Add(NewTetra);
-	}
-}
-
-void ADungeonMapper::GenerateConnectionFromTetras(const TArray<FTetrahedron>& Tetrahedrons)
-{
-	SCOPE_SECONDS_ACCUMULATOR(STAT_ConnectRooms);
-
-	DungeonConnections.Empty();
-	DungeonHallwaysData.Empty();
-	for (UDungeonRoomData* DungeonsRoom : DungeonNodes)
-	{
-		DungeonsRoom->Connections.Empty();
-	}
-
-	//we try to create a hallway from each tetrahedron edge
-	for (const FTetrahedron& Tetra : Tetrahedrons)
-	{
-		TryCreateConnection(Tetra.Vert1, Tetra.Vert2);
-		TryCreateConnection(Tetra.Vert2, Tetra.Vert3);
-		TryCreateConnection(Tetra.Vert3, Tetra.Vert1);
-		TryCreateConnection(Tetra.Vert4, Tetra.Vert1);
-		TryCreateConnection(Tetra.Vert4, Tetra.Vert2);
-		TryCreateConnection(Tetra.Vert4, Tetra.Vert3);
-	}
-
-	for (const FDungeonConnection& HallWay : DungeonConnections)
-	{
-		HallWay.StartRoom->Connections.Add(&HallWay);
-		HallWay.EndRoom->Connections.Add(&HallWay);
-	}
-}
-
-void ADungeonMapper::TryCreateConnection(UDungeonRoomData* StartRoom, UDungeonRoomData* EndRoom)
-{
-	FVector StartPoint = StartRoom->Location;
-	FVector EndPoint = EndRoom->Location;
-
-	//invalid if edge is connected to any of the dummy vertex created for the super tetrahedron
-	if(StartRoom->RoomType == ERoomType::Dummy || EndRoom->RoomType == ERoomType::Dummy)
-	{
-		return;
-	}
-	
-	for (const UDungeonRoomData* DungeonRoom : DungeonNodes)
-	{
-		if(DungeonRoom == StartRoom || DungeonRoom == EndRoom)
-		{
-			continue;
-		}
-		
-		FBox RoomBounds(DungeonRoom->Location - DungeonRoom->Extent, DungeonRoom->Location + DungeonRoom->Extent);
-		FVector Direction = EndPoint - StartPoint;
-
-		//invalid if edge would cross another room
-		const bool Intersect = FMath::LineBoxIntersection(RoomBounds, StartPoint, EndPoint, Direction,Direction.Reciprocal());
-		if(Intersect)
-		{
-			return;
-		}
-	}
-	const FDungeonConnection HallWay(StartRoom->Location,StartRoom, EndRoom->Location, EndRoom);
-	DungeonConnections.AddUnique(HallWay);
-}
-
-UDungeonHallwayData* ADungeonMapper::FixHallwayCrossingRoom(UDungeonRoomData* Room, const FVector& Start, const FVector& End)
-{
-	FBox RoomBox(Room->Location - Room->Extent, Room->Location + Room->Extent);
-
-	FVector HitLocation = FVector::ZeroVector;
-	FVector HitNormal = FVector::ZeroVector;
-	float HitTime = 0.0f;
-	const bool Interect = FMath::LineExtentBoxIntersection(RoomBox, Start, End, FVector::ZeroVector, HitLocation, HitNormal, HitTime);
-	if(Interect && HitTime > 0.0f &&  !FMath::IsNearlyEqual(HitTime, 1.0f, 0.00001f) )
-	{
-		UDungeonHallwayData* NewHallway = DuplicateObject(HallwayData, this);
-		NewHallway->Start = Start;
-		NewHallway->End = HitLocation;
-		NewHallway->Type = ECorridorType::HStraight;
-		NewHallway->Direction = (NewHallway->End - NewHallway->Start).GetSafeNormal();
-		return NewHallway;
-	}
-	return nullptr;
-}
-
-bool ADungeonMapper::HasHallwayReachedDestination(const FHallWayPathNode& PathNode, FVector& Out_HitPoint, FVector& Out_HitNormal)
-{
-	if(PathNode.Path.Num() < 2)
-	{
-		return false;
-	}
-	
-	FDungeonConnection& EvaluatedConnection = DungeonConnections[ConnectionID];
-	FBox EndRoom(EvaluatedConnection.EndRoom->Location - EvaluatedConnection.EndRoom->Extent, EvaluatedConnection.EndRoom->Location + EvaluatedConnection.EndRoom->Extent);
-	//EndRoom = EndRoom.ExpandBy(FVector(HallwayData->HallWaySectionDimensions.X, HallwayData->HallWaySectionDimensions.X, 0.0f));
-
-	float HitTime = 0.0f;
-	const bool IsIntersecting = FMath::LineExtentBoxIntersection(EndRoom, PathNode.Path.Last(1), PathNode.NodeLocation, FVector::ZeroVector,  Out_HitPoint, Out_HitNormal, HitTime);
-	return IsIntersecting && HitTime > 0 && HitTime < 1.0f;
-}
-
-void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallwayData* DungeonHallway)
+void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const FDungeonHallwaySegment& DungeonHallway)
 {
+	SCOPE_DUNGEON_STAT(STAT_RenderHallways);
 
 		UDynamicMesh* HallwayMesh = AllocateComputeMesh();
 		FGeometryScriptMeshBooleanOptions BoolOptions;
 	
-			FVector Start = DungeonHallway->Start;
-			FVector End = DungeonHallway->End;
+			FVector Start = DungeonHallway.Start;
+			FVector End = DungeonHallway.End;
 			const FVector HallWaySegment = End - Start;
 
 			FGeometryScriptPrimitiveOptions PrimitiveOptions;
 
-			switch (DungeonHallway->Type)
+			switch (DungeonHallway.Type)
 			{
 			case ECorridorType::HStraight:
 				{
-					Start += HallWaySegment.GetSafeNormal()*DungeonHallway->HallWaySectionDimensions.X;
-					End -= HallWaySegment.GetSafeNormal()*DungeonHallway->HallWaySectionDimensions.X;
+					Start += HallWaySegment.GetSafeNormal()*HallwayData->HallWaySectionDimensions.X;
+					End -= HallWaySegment.GetSafeNormal()*HallwayData->HallWaySectionDimensions.X;
 					HallwayMesh = UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallway
 						(
 							HallwayMesh
 							, PrimitiveOptions
 							, Start
 							, End
-							, DungeonHallway->HallWaySectionDimensions.X
-							,  DungeonHallway->HallWaySectionDimensions.Y
-							, DungeonHallway->WallThickness
+							, HallwayData->HallWaySectionDimensions.X
+							,  HallwayData->HallWaySectionDimensions.Y
+							, HallwayData->WallThickness
 							, true,3,0,0
 						);
 
@@ -1398,23 +435,23 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 					 // 							HallwayMesh
 					 // 							, PrimitiveOptions
 					 // 							, FTransform(HallWaySegment.Rotation(), Start + HallWaySegment.GetSafeNormal() * HallWaySegment.Length() * 0.5)
-					 // 							,  HallWaySegment.Length() - (DungeonHallway->HallWaySectionDimensions.X *0.5f)
-					 // 							, DungeonHallway->HallWaySectionDimensions.X
-					 // 							,  DungeonHallway->HallWaySectionDimensions.Y
-					 // 							, DungeonHallway->WallThickness
+					 // 							,  HallWaySegment.Length() - (HallwayData->HallWaySectionDimensions.X *0.5f)
+					 // 							, HallwayData->HallWaySectionDimensions.X
+					 // 							,  HallwayData->HallWaySectionDimensions.Y
+					 // 							, HallwayData->WallThickness
 					 // 							, true, 3, 0
 						// 						, 0,EGeometryScriptPrimitiveOriginMode::Center
 					 // 						);
 					
-					const FTransform FloorLocation(HallWaySegment.Rotation(), Start + (HallWaySegment * 0.5f) - FVector(0,0,DungeonHallway->HallWaySectionDimensions.Y * 0.5f - DungeonHallway->WallThickness * 0.5f));
-					FKBoxElem FloorShape(HallWaySegment.Length(), DungeonHallway->HallWaySectionDimensions.X, DungeonHallway->WallThickness);
+					const FTransform FloorLocation(HallWaySegment.Rotation(), Start + (HallWaySegment * 0.5f) - FVector(0,0,HallwayData->HallWaySectionDimensions.Y * 0.5f - HallwayData->WallThickness * 0.5f));
+					FKBoxElem FloorShape(HallWaySegment.Length(), HallwayData->HallWaySectionDimensions.X, HallwayData->WallThickness);
 					FloorShape.SetTransform(FloorLocation);
 					DungeonCollision.AggGeom.BoxElems.Add(FloorShape);
 				}
 				break;
 			case ECorridorType::HCorner:
 				{
-					FVector CornerPoint = Start + DungeonHallway->Direction * DungeonHallway->HallWaySectionDimensions.X;
+					FVector CornerPoint = Start + DungeonHallway.Direction * HallwayData->HallWaySectionDimensions.X;
 					HallwayMesh = UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallwayCorner
 						(
 							HallwayMesh
@@ -1422,20 +459,20 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 							, Start
 							, CornerPoint
 							, End
-							, DungeonHallway->HallWaySectionDimensions.X
-							,  DungeonHallway->HallWaySectionDimensions.Y
-							, DungeonHallway->WallThickness
+							, HallwayData->HallWaySectionDimensions.X
+							,  HallwayData->HallWaySectionDimensions.Y
+							, HallwayData->WallThickness
 							, true
 						);
-					// const FTransform FloorLocation(HallWaySegment.Rotation(), CornerPoint - FVector(0,0,DungeonHallway->HallWaySectionDimensions.Y * 0.5f - DungeonHallway->WallThickness * 0.5f));
-					// FKBoxElem FloorShape(DungeonHallway->HallWaySectionDimensions.X, DungeonHallway->HallWaySectionDimensions.X, DungeonHallway->WallThickness);
+					// const FTransform FloorLocation(HallWaySegment.Rotation(), CornerPoint - FVector(0,0,HallwayData->HallWaySectionDimensions.Y * 0.5f - HallwayData->WallThickness * 0.5f));
+					// FKBoxElem FloorShape(HallwayData->HallWaySectionDimensions.X, HallwayData->HallWaySectionDimensions.X, HallwayData->WallThickness);
 					// FloorShape.SetTransform(FloorLocation);
 					// DungeonCollision.AggGeom.BoxElems.Add(FloorShape);
 				}
 				break;
 			case ECorridorType::StairConnection:
 				{
-					FVector CornerPoint = Start + DungeonHallway->Direction * DungeonHallway->HallWaySectionDimensions.X;
+					FVector CornerPoint = Start + DungeonHallway.Direction * HallwayData->HallWaySectionDimensions.X;
 					HallwayMesh = UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallwayCorner
 						(
 							HallwayMesh
@@ -1443,28 +480,28 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 							, Start
 							, CornerPoint
 							, End
-							, DungeonHallway->HallWaySectionDimensions.X
-							,  DungeonHallway->HallWaySectionDimensions.Y
-							, DungeonHallway->WallThickness
+							, HallwayData->HallWaySectionDimensions.X
+							,  HallwayData->HallWaySectionDimensions.Y
+							, HallwayData->WallThickness
 							, true
 						);
 				}
 				break;
 			case ECorridorType::Stairs:
 				{
-					Start += HallWaySegment.GetSafeNormal()*DungeonHallway->HallWaySectionDimensions.X;
-					End -= HallWaySegment.GetSafeNormal()*DungeonHallway->HallWaySectionDimensions.X;
+					Start += HallWaySegment.GetSafeNormal()*HallwayData->HallWaySectionDimensions.X;
+					End -= HallWaySegment.GetSafeNormal()*HallwayData->HallWaySectionDimensions.X;
 					HallwayMesh = UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallway
 						(
 							HallwayMesh
 							, PrimitiveOptions
 							, Start
 							, End
-							, DungeonHallway->HallWaySectionDimensions.X
-							, DungeonHallway->HallWaySectionDimensions.Y
-							, DungeonHallway->WallThickness
-							, true, HallWaySegment.Length()/125 + 1, DungeonHallway->HallWaySectionDimensions.X/125 + 1
-							, DungeonHallway->HallWaySectionDimensions.Y/125 + 1
+							, HallwayData->HallWaySectionDimensions.X
+							, HallwayData->HallWaySectionDimensions.Y
+							, HallwayData->WallThickness
+							, true, HallWaySegment.Length()/125 + 1, HallwayData->HallWaySectionDimensions.X/125 + 1
+							, HallwayData->HallWaySectionDimensions.Y/125 + 1
 						);
 					
 					// float StairRise = HallWaySegment.Z;
@@ -1476,8 +513,8 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 					// (
 					// 	HallwayMesh
 					// 	, PrimitiveOptions
-					// 	, FTransform(HallWaySegment.GetSafeNormal2D().Rotation(), Start + FVector::DownVector*DungeonHallway->HallWaySectionDimensions.Y * 0.5f)
-					// 	, DungeonHallway->HallWaySectionDimensions.X
+					// 	, FTransform(HallWaySegment.GetSafeNormal2D().Rotation(), Start + FVector::DownVector*HallwayData->HallWaySectionDimensions.Y * 0.5f)
+					// 	, HallwayData->HallWaySectionDimensions.X
 					// 	, DungeonHallway->StepRise
 					// 	, StepRun
 					// 	, TotalSteps
@@ -1495,13 +532,13 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 						(
 							HallwayMesh
 							, PrimitiveOptions
-							, FTransform(DungeonHallway->Direction.Rotation(), DungeonHallway->Start + (HallWaySegment))
-							, DungeonHallway->HallWaySectionDimensions.X
-							, DungeonHallway->HallWaySectionDimensions.X
-							,  DungeonHallway->HallWaySectionDimensions.Y
-							, DungeonHallway->WallThickness
-							, true, HallWaySegment.Length()/125 + 1, DungeonHallway->HallWaySectionDimensions.X/125 + 1
-							, DungeonHallway->HallWaySectionDimensions.Y/125 + 1, EGeometryScriptPrimitiveOriginMode::Center
+							, FTransform(DungeonHallway.Direction.Rotation(), DungeonHallway.Start + (HallWaySegment))
+							, HallwayData->HallWaySectionDimensions.X
+							, HallwayData->HallWaySectionDimensions.X
+							,  HallwayData->HallWaySectionDimensions.Y
+							, HallwayData->WallThickness
+							, true, HallWaySegment.Length()/125 + 1, HallwayData->HallWaySectionDimensions.X/125 + 1
+							, HallwayData->HallWaySectionDimensions.Y/125 + 1, EGeometryScriptPrimitiveOriginMode::Center
 						);
 				}
 				break;
@@ -1510,9 +547,9 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 						(
 							HallwayMesh
 							, PrimitiveOptions
-							,FTransform(DungeonHallway->Direction.Rotation() + FRotator(-90, 0,0), DungeonHallway->Start + DungeonHallway->Direction * (DungeonHallway->HallWaySectionDimensions.Y * 0.5f))
-							, DungeonHallway->HallWaySectionDimensions.X * 0.5f
-							, DungeonHallway->HallWaySectionDimensions.Y * 0.5f
+							,FTransform(DungeonHallway.Direction.Rotation() + FRotator(-90, 0,0), DungeonHallway.Start + DungeonHallway.Direction * (HallwayData->HallWaySectionDimensions.Y * 0.5f))
+							, HallwayData->HallWaySectionDimensions.X * 0.5f
+							, HallwayData->HallWaySectionDimensions.Y * 0.5f
 							, 30
 							,HallWaySegment.Length()/125 + 1
 							,true
@@ -1521,6 +558,7 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 				break;
 			}
 		
+		INC_DWORD_STAT(STAT_BooleanOperations);
 		DynMesh = UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 				(
 					DynMesh,
@@ -1533,13 +571,13 @@ void ADungeonMapper::RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallway
 		ReleaseComputeMesh(HallwayMesh);
 }
 
-void ADungeonMapper::HallowHallWays(UDynamicMesh* DynamicMesh, const UDungeonHallwayData* DungeonHallway)
+void ADungeonMapper::HallowHallWays(UDynamicMesh* DynamicMesh, const FDungeonHallwaySegment& DungeonHallway)
 {
 		UDynamicMesh* HallwayMesh = AllocateComputeMesh();
 		FGeometryScriptMeshBooleanOptions BoolOptions;
 
-			const FVector Start = DungeonHallway->Start;
-			const FVector End = DungeonHallway->End;
+			const FVector Start = DungeonHallway.Start;
+			const FVector End = DungeonHallway.End;
 			const FVector HallWaySegment = End - Start;
 			if(HallWaySegment.Length() == 0.0f)
 			{
@@ -1548,7 +586,7 @@ void ADungeonMapper::HallowHallWays(UDynamicMesh* DynamicMesh, const UDungeonHal
 			}
 	
 		FGeometryScriptPrimitiveOptions PrimitiveOptions;
-		switch (DungeonHallway->Type) {
+		switch (DungeonHallway.Type) {
 		case ECorridorType::HStraight:
 			{
 				HallwayMesh = UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendBox
@@ -1557,44 +595,44 @@ void ADungeonMapper::HallowHallWays(UDynamicMesh* DynamicMesh, const UDungeonHal
 					, PrimitiveOptions
 					, FTransform(HallWaySegment.Rotation(), Start + (HallWaySegment * 0.5f))
 					, HallWaySegment.Length()
-					, DungeonHallway->HallWaySectionDimensions.X - DungeonHallway->WallThickness * 2.0f
-					,  DungeonHallway->HallWaySectionDimensions.Y - DungeonHallway->WallThickness * 2.0f
-					, HallWaySegment.Length()/125 + 1, DungeonHallway->HallWaySectionDimensions.X/125 + 1, DungeonHallway->HallWaySectionDimensions.Y/125 + 1
+					, HallwayData->HallWaySectionDimensions.X - HallwayData->WallThickness * 2.0f
+					,  HallwayData->HallWaySectionDimensions.Y - HallwayData->WallThickness * 2.0f
+					, HallWaySegment.Length()/125 + 1, HallwayData->HallWaySectionDimensions.X/125 + 1, HallwayData->HallWaySectionDimensions.Y/125 + 1
 					, EGeometryScriptPrimitiveOriginMode::Center
 				);
 			}
 			break;
 		case ECorridorType::HCorner:
 			{
-				FVector CornerPoint = Start + DungeonHallway->Direction + DungeonHallway->HallWaySectionDimensions.X;
+				FVector CornerPoint = Start + DungeonHallway.Direction + HallwayData->HallWaySectionDimensions.X;
 				FVector StartSegment = CornerPoint - Start;
 				HallwayMesh = UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendBox
 					(
 						HallwayMesh
 						, PrimitiveOptions
 						, FTransform(StartSegment.Rotation(), CornerPoint)
-						, DungeonHallway->HallWaySectionDimensions.X - DungeonHallway->WallThickness * 2.0f
-						, DungeonHallway->HallWaySectionDimensions.X - DungeonHallway->WallThickness * 2.0f
-						,  DungeonHallway->HallWaySectionDimensions.Y - DungeonHallway->WallThickness * 2.0f
-						, HallWaySegment.Length()/125 + 1, DungeonHallway->HallWaySectionDimensions.X/125 + 1, DungeonHallway->HallWaySectionDimensions.Y/125 + 1
+						, HallwayData->HallWaySectionDimensions.X - HallwayData->WallThickness * 2.0f
+						, HallwayData->HallWaySectionDimensions.X - HallwayData->WallThickness * 2.0f
+						,  HallwayData->HallWaySectionDimensions.Y - HallwayData->WallThickness * 2.0f
+						, HallWaySegment.Length()/125 + 1, HallwayData->HallWaySectionDimensions.X/125 + 1, HallwayData->HallWaySectionDimensions.Y/125 + 1
 						, EGeometryScriptPrimitiveOriginMode::Center
 					);
 			}
 			break;
 		case ECorridorType::StairConnection:
 			{
-				FVector CornerPoint = Start + DungeonHallway->Direction * DungeonHallway->HallWaySectionDimensions.X;
+				FVector CornerPoint = Start + DungeonHallway.Direction * HallwayData->HallWaySectionDimensions.X;
 				FVector StartSegment = CornerPoint - Start;
-				float Height = FMath::Abs(Start.Z - End.Z) + DungeonHallway->HallWaySectionDimensions.Y;
+				float Height = FMath::Abs(Start.Z - End.Z) + HallwayData->HallWaySectionDimensions.Y;
 				HallwayMesh = UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendBox
 					(
 						HallwayMesh
 						, PrimitiveOptions
 						, FTransform(StartSegment.Rotation(), CornerPoint)
-						, DungeonHallway->HallWaySectionDimensions.X - DungeonHallway->WallThickness * 2.0f
-						, DungeonHallway->HallWaySectionDimensions.X - DungeonHallway->WallThickness * 2.0f
-						,  DungeonHallway->HallWaySectionDimensions.Y - DungeonHallway->WallThickness * 2.0f
-						, HallWaySegment.Length()/125 + 1, DungeonHallway->HallWaySectionDimensions.X/125 + 1, DungeonHallway->HallWaySectionDimensions.Y/125 + 1
+						, HallwayData->HallWaySectionDimensions.X - HallwayData->WallThickness * 2.0f
+						, HallwayData->HallWaySectionDimensions.X - HallwayData->WallThickness * 2.0f
+						,  HallwayData->HallWaySectionDimensions.Y - HallwayData->WallThickness * 2.0f
+						, HallWaySegment.Length()/125 + 1, HallwayData->HallWaySectionDimensions.X/125 + 1, HallwayData->HallWaySectionDimensions.Y/125 + 1
 						, EGeometryScriptPrimitiveOriginMode::Center
 					);
 			}
@@ -1607,9 +645,9 @@ void ADungeonMapper::HallowHallWays(UDynamicMesh* DynamicMesh, const UDungeonHal
 						, PrimitiveOptions
 						, FTransform(HallWaySegment.GetSafeNormal2D().Rotation(), Start + (HallWaySegment * 0.5f))
 						, HallWaySegment.Size2D()
-						, DungeonHallway->HallWaySectionDimensions.X - DungeonHallway->WallThickness * 2.0f
-						,  HallWaySegment.Z + DungeonHallway->HallWaySectionDimensions.Y - DungeonHallway->WallThickness * 2.0f
-						, HallWaySegment.Length()/125 + 1, DungeonHallway->HallWaySectionDimensions.X/125 + 1, DungeonHallway->HallWaySectionDimensions.Y/125 + 1
+						, HallwayData->HallWaySectionDimensions.X - HallwayData->WallThickness * 2.0f
+						,  HallWaySegment.Z + HallwayData->HallWaySectionDimensions.Y - HallwayData->WallThickness * 2.0f
+						, HallWaySegment.Length()/125 + 1, HallwayData->HallWaySectionDimensions.X/125 + 1, HallwayData->HallWaySectionDimensions.Y/125 + 1
 						, EGeometryScriptPrimitiveOriginMode::Center
 					);
 			}
@@ -1620,6 +658,7 @@ void ADungeonMapper::HallowHallWays(UDynamicMesh* DynamicMesh, const UDungeonHal
 			break;
 		}
 	
+		INC_DWORD_STAT(STAT_BooleanOperations);
 		DynamicMesh = UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 					(
 						DynamicMesh,
@@ -3,152 +3,20 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "DungeonLayout.h"
 #include "DungeonMapperData.h"
-#include "TriangulatorData.h"
+#include "DungeonSeedSearch.h"
 #include "GameFramework/Actor.h"
 #include "GeometryScript/GeometryScriptTypes.h"
 #include "DungeonMapper.generated.h"
 
 
 class ADungeonRoom;
-class UTextRenderComponent;
 class UDynamicMeshPool;
 class UDynamicMesh;
 class UDynamicMeshComponent;
-class UProceduralMeshComponent;
-struct FDungeonNode;
-struct FDungeonConnection;
-class ANavMeshBoundsVolume;
-class UDungeonHallwayPathFinder;
 
-DECLARE_LOG_CATEGORY_EXTERN(LogDungeonGenerator, Log, All);
-
-// PROFILER INTEGRATION //
-DECLARE_STATS_GROUP(TEXT("Procedural Dungeon"), STATGROUP_ProcDungeon, STATCAT_DungeonMapper);
-
-DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Generate Rooms"), STAT_GenerateRooms, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
-DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Connect Rooms"), STAT_ConnectRooms, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
-DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Simplify Connections"), STAT_SimplifyConections, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
-DECLARE_CYCLE_STAT_EXTERN(TEXT("Dungeon Mapper / Render Dungeon"), STAT_RenderDungeon, STATGROUP_ProcDungeon, DUNGEONGENERATOR_API);
-
-UENUM(blueprintType)
-enum class EHallwayGenerationMethod : uint8
-{
-	Basic,
-	PathFinding
-};
-USTRUCT()
-struct FDungeonPath
-{
-	GENERATED_BODY()
-	UPROPERTY()
-	UDungeonRoomData* Start = nullptr;
-	UPROPERTY()
-	UDungeonRoomData* End = nullptr;
-	TArray<const FDungeonConnection*> Path;
-	float DistanceTraveled = 0;
-	void AssignPath(TArray<const FDungeonConnection*>& NewPath)
-	{
-		Path = NewPath;
-		for (const FDungeonConnection* HallWay : Path)
-		{
-			DistanceTraveled+= FVector::Dist(HallWay->EndRoom->Location, HallWay->StartRoom->Location);
-		}
-	}
-};
-
-
-USTRUCT()
-struct FHallWayPath
-{
-	GENERATED_BODY()
-	FVector Start = FVector::ZeroVector;
-	FVector End = FVector::ZeroVector;
-	TArray<FVector> Path;
-	float DistanceTraveled = 0;
-	void AssignPath(TArray<FVector>& NewPath)
-	{
-		DistanceTraveled = 0;
-		Path = NewPath;
-		for (int i = 0; i < Path.Num() - 1; ++i)
-		{
-			DistanceTraveled += FVector::Dist(Path[i + 1], Path[i]);
-		}
-	}
-};
-
-struct FPathNode
-{
-	UDungeonRoomData* Room = nullptr;
-	TArray<const FDungeonConnection*> Path;
-	float G = 0;
-	float F = 0;
-	float H = 0;
-	FPathNode(UDungeonRoomData* InRoom)
-		: Room(InRoom)
-	{}
-
-	FPathNode(const FPathNode& Node,const FDungeonConnection* InHallway)
-	{
-		if(InHallway->StartRoom != Node.Room)
-		{
-			Room = InHallway->StartRoom;
-		}
-		else if(InHallway->EndRoom != Node.Room)
-		{
-			Room = InHallway->EndRoom;
-		}
-		for (const FDungeonConnection* Hallway : Node.Path)
-		{
-			Path.Add(Hallway);
-		}
-		Path.Add(InHallway);
-	}
-		
-	bool operator==(const FPathNode& Other) const
-	{
-		return Room == Other.Room;
-	}
-
-	bool operator<(const FPathNode& Other) const
-	{
-		return F > Other.F;
-	}
-};
-
-struct FHallWayPathNode
-{
-	FVector NodeLocation;
-	TArray<FVector> Path;
-	float G = 0;
-	float F = 0;
-	float H = 0;
-	FHallWayPathNode(FVector InNodeLocation)
-		: NodeLocation(InNodeLocation)
-	{
-		Path.Add(NodeLocation);
-	}
-
-	FHallWayPathNode(const FHallWayPathNode& Node, FVector InNodeLocation)
-	{
-		NodeLocation = InNodeLocation;
-		for (const FVector& PathNode : Node.Path)
-		{
-			Path.Add(PathNode);
-		}
-		Path.Add(InNodeLocation);
-	}
-		
-	bool operator==(const FHallWayPathNode& Other) const
-	{
-		return NodeLocation.Equals(Other.NodeLocation);
-	}
-
-	bool operator<(const FHallWayPathNode& Other) const
-	{
-		return F > Other.F;
-	}
-};
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDungeonGenerated, ADungeonMapper*, DungeonMapper, bool, bSuccess);
 
 UCLASS(BlueprintType, Blueprintable)
 class DUNGEONGENERATOR_API ADungeonMapper : public AActor
@@ -164,10 +32,41 @@ public:
 	//Override - AActor - START
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 	//Override - AActor - END
+
+	/**
+	 * Runs the whole layout pipeline on worker threads. Rendering and OnDungeonGenerated happen back on the game thread
+	 * once the layout is ready. Returns false if the generation couldn't be started.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Mapper|Generators")
+	bool GenerateDungeonAsync();
+	/** Details panel button for GenerateDungeonAsync, editor buttons can't have a return value. */
+	UFUNCTION(CallInEditor, Category = "Dungeon Mapper|Generators")
+	void GenerateDungeonAsyncInEditor();
+	bool IsGeneratingAsync() const { return bIsGeneratingAsync; }
+
+	/** Replaces the current layout, e.g. with one generated away from this actor. Call RenderDungeon to build it. */
+	void SetLayout(FDungeonLayout&& InLayout);
+	const FDungeonLayout& GetLayout() const { return DungeonLayout; }
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
+	void RenderDungeon();
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
+	void ClearAll();
+	/** Fraction of the connections that have their hallways, while they are created over several frames. */
+	UFUNCTION(BlueprintPure, Category = "Dungeon Mapper|Generators")
+	float GetHallwaysCreationProgress() const { return DungeonLayout.GetHallwaysCreationProgress(); }
+	/** Triangles of the rendered hallways plus every spawned room. */
+	int32 GetRenderedTriangleCount() const;
+
+	/** Evaluates every candidate seed with the current configuration on all cores. Accepted seeds are returned longest critical path first. */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Mapper|Generators")
+	TArray<FDungeonSeedResult> FindSeeds(const TArray<FName>& CandidateSeeds, const FDungeonSeedConstraints& Constraints) const;
 private:
+	void FinishGenerationAsync(FDungeonLayout&& GeneratedLayout, int32 GenerationID);
 	void RunHallwaysCreation();
 	void RunPhysics(float DeltaSeconds);
 	void Debug();
+	/** Gathers the actor configuration and the navigable bounds of the world into layout settings. */
+	bool MakeLayoutSettings(FDungeonLayoutSettings& OutSettings) const;
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
 	void GenerateDungeonRooms();
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
@@ -176,30 +75,15 @@ private:
 	void SimplifyConnections();
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
 	void Collapse();
-	UDungeonHallwayData* CreateConnectionFromEdgePoint(UDungeonRoomData* ConnectedRoom, FVector Start, FVector End);
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
 	void CreateHallways();
-	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
-	void RenderDungeon();
-	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
-	void ClearAll();
 
 	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Dungeon Mapper|Generators")
 	void NextStep();
 	
-	//Connection creation
-	void EvaluateVertex(UDungeonRoomData* Vertex, TArray<FTetrahedron>& OutTetrahedrons) const;
-	void GenerateConnectionFromTetras(const TArray<FTetrahedron>& Tetrahedrons);
-	void TryCreateConnection(UDungeonRoomData* StartRoom, UDungeonRoomData* EndRoom);
-
-	//Hallway Creation
-	UDungeonHallwayData* FixHallwayCrossingRoom(UDungeonRoomData* Room, const FVector& Start, const FVector& End);
-	bool HasHallwayReachedDestination(const FHallWayPathNode& PathNode, FVector& Out_HitPoint, FVector& Out_HitNormal);
-	void CreateHallwaysFromPath(const TArray<FVector>& Path);
-	
 	//Rendering
-	void RenderHallWays(UDynamicMesh* DynMesh, const UDungeonHallwayData* DungeonHallway);
-	void HallowHallWays(UDynamicMesh* DynamicMesh, const UDungeonHallwayData* DungeonHallway);
+	void RenderHallWays(UDynamicMesh* DynMesh, const FDungeonHallwaySegment& DungeonHallway);
+	void HallowHallWays(UDynamicMesh* DynamicMesh, const FDungeonHallwaySegment& DungeonHallway);
 	
 	/** Access the compute mesh pool */
 	UDynamicMeshPool* GetComputeMeshPool();
@@ -224,9 +108,27 @@ public:
 	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation")
 	FName RandomSeed;
 	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation")
+	ERoomPlacementMethod RoomPlacementMethod = ERoomPlacementMethod::RandomCell;
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation")
+	ETriangulationBackend TriangulationBackend = ETriangulationBackend::Auto;
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation")
 	float MaxHallwaySlope = 45.0f;
 	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation")
+	EConnectionSimplificationMethod ConnectionSimplificationMethod = EConnectionSimplificationMethod::ShortestPathTree;
+	//Fraction of the connections left out of the minimum spanning tree that are added back as loops
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation", meta = (ClampMin = "0", ClampMax = "1", EditCondition = "ConnectionSimplificationMethod == EConnectionSimplificationMethod::MinimumSpanningTree"))
+	float ExtraConnectionRatio = 0.0f;
+	//Longest detour the greedy spanner allows between two connected rooms, relative to their connection length
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation", meta = (ClampMin = "1", EditCondition = "ConnectionSimplificationMethod == EConnectionSimplificationMethod::GreedySpanner"))
+	float SpannerStretch = 1.5f;
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation")
 	EHallwayGenerationMethod HallWayGenerationMethod = EHallwayGenerationMethod::Basic;
+	//Milliseconds of hallway path finding per frame for Create Hallways, 0 finds every path at once on worker threads
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation", meta = (ClampMin = "0", EditCondition = "HallWayGenerationMethod == EHallwayGenerationMethod::PathFinding"))
+	float HallwayFrameBudgetMs = 0.0f;
+	//Safety net for the path finder, a hallway search expanding more nodes than this is abandoned for a basic hallway
+	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation", meta = (ClampMin = "1", EditCondition = "HallWayGenerationMethod == EHallwayGenerationMethod::PathFinding"))
+	int32 MaxPathFinderIterations = 100000;
 	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation|Physics")
 	float SpringConstant = 1.0f;
 	UPROPERTY(EditAnywhere, category = "Dungeon Mapper|Generation|Physics")
@@ -261,16 +163,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Dungeon Mapper|Debug")
 	float TickInterval = 0.0f;
 
+	UPROPERTY(BlueprintAssignable, category = "Dungeon Mapper|Generation")
+	FOnDungeonGenerated OnDungeonGenerated;
+
 protected:
 	
-	UPROPERTY()
-	TArray<UDungeonRoomData*> DungeonNodes;
+	FDungeonLayout DungeonLayout;
 	UPROPERTY()
 	TArray<ADungeonRoom*> DungeonRooms;
-	TArray<FDungeonConnection> DungeonConnections;
-	UPROPERTY()
-	TArray<UDungeonHallwayData*> DungeonHallwaysData;
-	FBox DungeonBounds;
 	
 	UPROPERTY(Category = "Dungeon Mapper", VisibleAnywhere, BlueprintReadOnly, meta = (ExposeFunctionCategories = "Mesh,Rendering,Physics,Components|StaticMesh", AllowPrivateAccess = "true"))
 	TObjectPtr<UDynamicMeshComponent> DynamicMeshComponent;
@@ -281,12 +181,12 @@ protected:
 
 	//Collapsing Variables
 	bool bIsCollapsing = false;
-	int32 CollapsingIterationNotModified = 0;
 
 	//HallCreation Variables
 	bool bIsCreatingHallways = false;
-	int32 ConnectionID = 0;
-	UPROPERTY()
-	UDungeonHallwayPathFinder* DungeonHallwayPathFinder = nullptr;
 
+	//Async Generation Variables
+	bool bIsGeneratingAsync = false;
+	//Bumped on every request so results of superseded or cleared generations are dropped
+	int32 AsyncGenerationID = 0;
 };
\ No newline at end of file
@@ -3,13 +3,13 @@
 
 #include "DungeonMapperData.h"
 
-void FDungeonConnection::GetWallConnectionPoints(FVector& out_Point1, FVector& out_Point2) const
+void FDungeonConnection::GetWallConnectionPoints(const TArray<FDungeonNode>& Rooms, FVector& out_Point1, FVector& out_Point2) const
 {
-	FBox StartRoomBox(StartRoom->Location - StartRoom->Extent,StartRoom->Location + StartRoom->Extent);
-	FBox EndRoomBox(EndRoom->Location - EndRoom->Extent,EndRoom->Location + EndRoom->Extent);
+	const FDungeonNode& Start = Rooms[StartRoom];
+	const FDungeonNode& End = Rooms[EndRoom];
 	
 	FVector ImpactNormal;
 	float Time;
-	FMath::LineExtentBoxIntersection(EndRoomBox, StartRoom->Location, EndRoom->Location, FVector::ZeroVector,out_Point2, ImpactNormal, Time);
-	FMath::LineExtentBoxIntersection(StartRoomBox, EndRoom->Location, StartRoom->Location, FVector::ZeroVector,out_Point1, ImpactNormal, Time);
+	FMath::LineExtentBoxIntersection(End.GetBounds(), Start.Location, End.Location, FVector::ZeroVector,out_Point2, ImpactNormal, Time);
+	FMath::LineExtentBoxIntersection(Start.GetBounds(), End.Location, Start.Location, FVector::ZeroVector,out_Point1, ImpactNormal, Time);
 }
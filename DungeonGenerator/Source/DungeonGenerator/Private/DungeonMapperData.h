@@ -5,8 +5,6 @@
 #include "CoreMinimal.h"
 #include "DungeonMapperData.generated.h"
 
-struct FDungeonConnection;
-
 UENUM()
 enum class ERoomType : uint8
 {
@@ -30,31 +28,60 @@ enum class ECorridorType : uint8
 	Count UMETA(Hidden)
 };
 
+UENUM(BlueprintType)
+enum class ERoomPlacementMethod : uint8
+{
+	//Random cells, retrying until a free one comes up. Keeps the layouts of existing seeds
+	RandomCell,
+	//Cells drawn from a seeded permutation of the grid, every draw lands on a free cell
+	ShuffledCell,
+	//Blue noise placement without a grid, rooms spread over the bounds without overlapping
+	PoissonDisk
+};
+
+UENUM(BlueprintType)
+enum class ETriangulationBackend : uint8
+{
+	//BowyerWatson, or ParallelBowyerWatson from the layout's ParallelTriangulationMinRooms
+	Auto,
+	//Incremental Bowyer-Watson on the calling thread
+	BowyerWatson,
+	//Bowyer-Watson split in cells triangulated over worker threads, same edges as BowyerWatson
+	ParallelBowyerWatson,
+	//GeometryCore's Delaunay3. Triangulates without a super tetrahedron, so hull edges can differ from Bowyer-Watson
+	GeometryCore
+};
+
+UENUM(BlueprintType)
+enum class EConnectionSimplificationMethod : uint8
+{
+	//Shortest paths from the starting room to every other room
+	ShortestPathTree,
+	//Minimum spanning tree of the connections, plus a seeded share of the rest as loops
+	MinimumSpanningTree,
+	//Fewest connections keeping every connected pair of rooms within a detour factor of their connection length
+	GreedySpanner
+};
+
+UENUM(BlueprintType)
+enum class EHallwayGenerationMethod : uint8
+{
+	Basic,
+	PathFinding
+};
+
 UCLASS(Blueprintable, BlueprintType)
 class UDungeonRoomData : public UDataAsset
 {
 	GENERATED_BODY()
 
 public:
-	FVector Location;
-	FVector Extent;
-	ERoomType RoomType = ERoomType::Mid;
-	TArray<const FDungeonConnection*> Connections;
-	TArray<FTransform> Doors;
-
-	FVector Velocity = FVector::ZeroVector;
-	FVector PrevLocation = FVector::ZeroVector;
 	UPROPERTY(EditDefaultsOnly)
 	float WallThickness = 0;
 	UPROPERTY(EditDefaultsOnly)
 	UStaticMesh* DoorMesh = nullptr;
 	UPROPERTY(EditDefaultsOnly)
 	UMaterialInterface* WallMaterial;
-
-	bool operator==(const UDungeonRoomData* Other) const
-	{
-		return Location.Equals(Other->Location) && Extent.Equals(Other->Extent);
-	}
 };
 
 UCLASS(Blueprintable, BlueprintType)
@@ -73,52 +100,74 @@ public:
 
 	UPROPERTY(EditDefaultsOnly)
 	UMaterialInterface* WallMaterial;
+};
 
-	FVector Start;
-	FVector End;
-	FVector Direction;
-	ECorridorType Type;
-	bool bIsInvalid = false;
-	
-	bool operator==(const UDungeonHallwayData* Other) const
-	{
-		const float MarginRadius = FMath::Sqrt(HallWaySectionDimensions.X * HallWaySectionDimensions.X + HallWaySectionDimensions.Y * HallWaySectionDimensions.Y);
-		const bool StartPointsMatch = FVector::PointsAreNear(Start, Other->Start, MarginRadius);
-		const bool EndPointsMatch = FVector::PointsAreNear(End, Other->End, MarginRadius);
-		const bool StartEndPointsMatch = FVector::PointsAreNear(Start, Other->End, MarginRadius);
-		const bool EndStartPointsMatch = FVector::PointsAreNear(End, Other->Start, MarginRadius);
+// Plain layout data, produced by FDungeonLayout. Rooms and connections reference each other by index so the whole
+// layout can be built off the game thread and copied around freely.
 
-		return (StartPointsMatch && EndPointsMatch) || (StartEndPointsMatch && EndStartPointsMatch);
+struct FDungeonNode
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Extent = FVector::ZeroVector;
+	ERoomType RoomType = ERoomType::Mid;
+	TArray<FTransform> Doors;
+
+	FVector Velocity = FVector::ZeroVector;
+	FVector PrevLocation = FVector::ZeroVector;
+
+	FBox GetBounds() const
+	{
+		return FBox(Location - Extent, Location + Extent);
 	}
 };
 
-USTRUCT(BlueprintType)
 struct FDungeonConnection
 {
-	GENERATED_BODY()
-
-	UPROPERTY()
-	UDungeonRoomData* StartRoom;
-	UPROPERTY()
-	UDungeonRoomData* EndRoom;
+	//Indices into FDungeonLayout::DungeonNodes
+	int32 StartRoom;
+	int32 EndRoom;
 
-	void GetWallConnectionPoints(FVector& out_Point1, FVector& out_Point2) const;
 	FDungeonConnection()
-	: StartRoom(nullptr)
-	, EndRoom(nullptr)
+	: StartRoom(INDEX_NONE)
+	, EndRoom(INDEX_NONE)
 	{
-		
+
 	}
 
-	FDungeonConnection(const FVector& InStartPoint, UDungeonRoomData* InStartRoom, const FVector& InEndPoint, UDungeonRoomData* EndRoom)
+	FDungeonConnection(int32 InStartRoom, int32 InEndRoom)
 	: StartRoom(InStartRoom)
-	, EndRoom(EndRoom)
+	, EndRoom(InEndRoom)
 	{}
-	
+
+	void GetWallConnectionPoints(const TArray<FDungeonNode>& Rooms, FVector& out_Point1, FVector& out_Point2) const;
+
+	int32 GetOtherRoom(int32 Room) const
+	{
+		return StartRoom == Room ? EndRoom : StartRoom;
+	}
+
 	bool operator==(const FDungeonConnection& Other) const
 	{
 		const bool StartRoomDup = StartRoom == Other.StartRoom || StartRoom == Other.EndRoom;
 		const bool EndRoomDup = EndRoom == Other.StartRoom || EndRoom == Other.EndRoom;
 		return StartRoomDup && EndRoomDup;
 	}
-};
\ No newline at end of file
+};
+
+struct FDungeonHallwaySegment
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FVector Direction = FVector::ZeroVector;
+	ECorridorType Type = ECorridorType::HStraight;
+	bool bIsInvalid = false;
+
+	FDungeonHallwaySegment() {}
+
+	FDungeonHallwaySegment(const FVector& InStart, const FVector& InEnd, ECorridorType InType)
+	: Start(InStart)
+	, End(InEnd)
+	, Direction((InEnd - InStart).GetSafeNormal())
+	, Type(InType)
+	{}
+};
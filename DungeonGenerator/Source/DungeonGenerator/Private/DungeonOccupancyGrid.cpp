@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonOccupancyGrid.h"
+
+void FDungeonOccupancyGrid::Reset(const FVector& InVoxelSize)
+{
+	Reset();
+	VoxelSize = InVoxelSize.ComponentMax(FVector::OneVector);
+}
+
+void FDungeonOccupancyGrid::Reset()
+{
+	Bricks.Reset();
+}
+
+void FDungeonOccupancyGrid::AddBox(const FBox& Box)
+{
+	if(!Box.IsValid)
+	{
+		return;
+	}
+	const FIntVector MinVoxel = GetVoxel(Box.Min);
+	const FIntVector MaxVoxel = GetVoxel(Box.Max);
+	//Whole bricks at a time, each one only gets the bits of the voxels inside the box
+	const FIntVector MinBrick = GetBrick(MinVoxel);
+	const FIntVector MaxBrick = GetBrick(MaxVoxel);
+	for (int32 BrickZ = MinBrick.Z; BrickZ <= MaxBrick.Z; ++BrickZ)
+	{
+		for (int32 BrickY = MinBrick.Y; BrickY <= MaxBrick.Y; ++BrickY)
+		{
+			for (int32 BrickX = MinBrick.X; BrickX <= MaxBrick.X; ++BrickX)
+			{
+				const FIntVector BrickOrigin(BrickX << BrickShift, BrickY << BrickShift, BrickZ << BrickShift);
+				const FIntVector FirstVoxel(FMath::Max(MinVoxel.X, BrickOrigin.X), FMath::Max(MinVoxel.Y, BrickOrigin.Y), FMath::Max(MinVoxel.Z, BrickOrigin.Z));
+				const FIntVector LastVoxel(FMath::Min(MaxVoxel.X, BrickOrigin.X + BrickSize - 1), FMath::Min(MaxVoxel.Y, BrickOrigin.Y + BrickSize - 1), FMath::Min(MaxVoxel.Z, BrickOrigin.Z + BrickSize - 1));
+				uint64 BrickBits = 0;
+				for (int32 Z = FirstVoxel.Z; Z <= LastVoxel.Z; ++Z)
+				{
+					for (int32 Y = FirstVoxel.Y; Y <= LastVoxel.Y; ++Y)
+					{
+						for (int32 X = FirstVoxel.X; X <= LastVoxel.X; ++X)
+						{
+							BrickBits |= GetVoxelBit(FIntVector(X, Y, Z));
+						}
+					}
+				}
+				Bricks.FindOrAdd(FIntVector(BrickX, BrickY, BrickZ)) |= BrickBits;
+			}
+		}
+	}
+}
+
+void FDungeonOccupancyGrid::AddSegment(const FVector& Start, const FVector& End, const FVector& HalfExtent)
+{
+	//Boxes along the segment, close enough that the gaps between them are covered by their extent
+	const double Step = FMath::Max(FMath::Min(VoxelSize.GetMin(), HalfExtent.GetMin()), 1.0);
+	const int32 NumSteps = FMath::Max(FMath::CeilToInt(FVector::Dist(Start, End) / Step), 1);
+	for (int32 StepIdx = 0; StepIdx <= NumSteps; ++StepIdx)
+	{
+		const FVector Center = FMath::Lerp(Start, End, static_cast<double>(StepIdx) / NumSteps);
+		AddBox(FBox(Center - HalfExtent, Center + HalfExtent));
+	}
+}
+
+bool FDungeonOccupancyGrid::IsOccupied(const FVector& Location) const
+{
+	const FIntVector Voxel = GetVoxel(Location);
+	const uint64* BrickBits = Bricks.Find(GetBrick(Voxel));
+	return BrickBits && (*BrickBits & GetVoxelBit(Voxel)) != 0;
+}
+
+FIntVector FDungeonOccupancyGrid::GetVoxel(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X / VoxelSize.X), FMath::FloorToInt(Location.Y / VoxelSize.Y), FMath::FloorToInt(Location.Z / VoxelSize.Z));
+}
+
+uint64 FDungeonOccupancyGrid::GetVoxelBit(const FIntVector& Voxel)
+{
+	constexpr int32 VoxelMask = BrickSize - 1;
+	const int32 Bit = ((Voxel.Z & VoxelMask) << (BrickShift * 2)) | ((Voxel.Y & VoxelMask) << BrickShift) | (Voxel.X & VoxelMask);
+	return uint64(1) << Bit;
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Sparse voxel occupancy of a layout. Voxels are grouped in bricks of BrickSize^3 stored as one 64 bit mask, and only
+ * bricks with something in them are allocated, so a point query is a hash lookup and a bit test however big the dungeon
+ * is. Shapes are added conservatively: every voxel they touch is occupied.
+ */
+class DUNGEONGENERATOR_API FDungeonOccupancyGrid
+{
+public:
+	static constexpr int32 BrickSize = 4;
+	static constexpr int32 BrickShift = 2;
+
+	/** Empties the grid and sets the size its voxels get from now on. */
+	void Reset(const FVector& InVoxelSize);
+	void Reset();
+	bool IsEmpty() const { return Bricks.IsEmpty(); }
+	int32 GetNumBricks() const { return Bricks.Num(); }
+	const FVector& GetVoxelSize() const { return VoxelSize; }
+
+	/** Occupies every voxel the box overlaps. */
+	void AddBox(const FBox& Box);
+	/** Occupies every voxel a box of HalfExtent swept from Start to End overlaps. */
+	void AddSegment(const FVector& Start, const FVector& End, const FVector& HalfExtent);
+	bool IsOccupied(const FVector& Location) const;
+
+private:
+	FIntVector GetVoxel(const FVector& Location) const;
+	static FIntVector GetBrick(const FIntVector& Voxel) { return FIntVector(Voxel.X >> BrickShift, Voxel.Y >> BrickShift, Voxel.Z >> BrickShift); }
+	static uint64 GetVoxelBit(const FIntVector& Voxel);
+
+	FVector VoxelSize = FVector::OneVector;
+	TMap<FIntVector, uint64> Bricks;
+};
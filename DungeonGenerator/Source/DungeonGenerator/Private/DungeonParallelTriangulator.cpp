@@ -0,0 +1,415 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonParallelTriangulator.h"
+
+#include "Async/Fundamental/Scheduler.h"
+#include "Async/ParallelFor.h"
+#include "DungeonPredicates.h"
+#include "DungeonTriangulator.h"
+
+void FDungeonParallelTriangulator::Triangulate(TConstArrayView<FVector> InPoints)
+{
+	Reset();
+	if(InPoints.IsEmpty())
+	{
+		return;
+	}
+
+	NumPoints = InPoints.Num();
+	Points.Reserve(NumPoints + 4);
+	Points.Append(InPoints.GetData(), InPoints.Num());
+	TArray<int32> PointIndices;
+	PointIndices.SetNumUninitialized(NumPoints);
+	for (int32 PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+	{
+		SuperBounds += Points[PointIdx];
+		PointIndices[PointIdx] = PointIdx;
+	}
+	FDungeonTriangulator::AppendSuperVertices(SuperBounds, Points);
+	TriangulateSubset(PointIndices, 0, Tetrahedra);
+}
+
+void FDungeonParallelTriangulator::Reset()
+{
+	Points.Reset();
+	NumPoints = 0;
+	SuperBounds = FBox(ForceInit);
+	Tetrahedra.Reset();
+}
+
+void FDungeonParallelTriangulator::GetEdges(TArray<uint64>& OutEdges) const
+{
+	static constexpr int32 TetraEdges[6][2] = {{0, 1}, {1, 2}, {2, 0}, {3, 0}, {3, 1}, {3, 2}};
+	OutEdges.Reset();
+	for (const FIntVector4& Tetra : Tetrahedra)
+	{
+		for (const int32 (&Edge)[2] : TetraEdges)
+		{
+			if(!IsSuperVertex(Tetra[Edge[0]]) && !IsSuperVertex(Tetra[Edge[1]]))
+			{
+				OutEdges.Add(FDungeonTriangulator::MakeEdge(Tetra[Edge[0]], Tetra[Edge[1]]));
+			}
+		}
+	}
+	FDungeonTriangulator::SortUniqueEdges(OutEdges);
+}
+
+void FDungeonParallelTriangulator::TriangulateSubset(TConstArrayView<int32> PointIndices, int32 Depth, TArray<FIntVector4>& OutTetrahedra) const
+{
+	if(PointIndices.Num() < MinParallelPoints || Depth > MaxDepth)
+	{
+		TriangulateSerial(PointIndices, OutTetrahedra);
+		return;
+	}
+
+	//Each split halves the cells along the axis they are longest in, until every worker has a few or they get too small
+	FCellGrid Grid;
+	for (const int32 PointIdx : PointIndices)
+	{
+		Grid.Bounds += Points[PointIdx];
+	}
+	const FVector SubsetSize = Grid.Bounds.GetSize();
+	const int32 NumWorkers = FMath::Max(static_cast<int32>(LowLevelTasks::FScheduler::Get().GetNumWorkers()), 1);
+	const int32 TargetCells = FMath::Min(PointIndices.Num() / MinPointsPerCell, NumWorkers * CellsPerWorker);
+	while (Grid.Num() * 2 <= TargetCells)
+	{
+		int32 SplitAxis = 0;
+		for (int32 Axis = 1; Axis < 3; ++Axis)
+		{
+			if(SubsetSize[Axis] / Grid.Splits[Axis] > SubsetSize[SplitAxis] / Grid.Splits[SplitAxis])
+			{
+				SplitAxis = Axis;
+			}
+		}
+		Grid.Splits[SplitAxis] *= 2;
+	}
+
+	//Average distance between points, over the axes they spread along
+	double SpreadVolume = 1.0;
+	int32 SpreadAxes = 0;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Grid.CellSize[Axis] = FMath::Max(SubsetSize[Axis] / Grid.Splits[Axis], UE_DOUBLE_SMALL_NUMBER);
+		if(SubsetSize[Axis] > UE_DOUBLE_SMALL_NUMBER)
+		{
+			SpreadVolume *= SubsetSize[Axis];
+			++SpreadAxes;
+		}
+	}
+	Grid.Halo = SpreadAxes > 0 ? HaloSpacings * FMath::Pow(SpreadVolume / PointIndices.Num(), 1.0 / SpreadAxes) : 0.0;
+
+	TArray<int32> PointCells;
+	PointCells.SetNumUninitialized(Points.Num());
+	TArray<TArray<int32>> CellPoints;
+	CellPoints.SetNum(Grid.Num());
+	for (const int32 PointIdx : PointIndices)
+	{
+		const FVector& Point = Points[PointIdx];
+		FIntVector CoreCell, FirstCell, LastCell;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			CoreCell[Axis] = Grid.GetCellCoord(Point[Axis], Axis);
+			FirstCell[Axis] = Grid.GetCellCoord(Point[Axis] - Grid.Halo, Axis);
+			LastCell[Axis] = Grid.GetCellCoord(Point[Axis] + Grid.Halo, Axis);
+		}
+		PointCells[PointIdx] = Grid.GetCell(CoreCell);
+		for (int32 Z = FirstCell.Z; Z <= LastCell.Z; ++Z)
+		{
+			for (int32 Y = FirstCell.Y; Y <= LastCell.Y; ++Y)
+			{
+				for (int32 X = FirstCell.X; X <= LastCell.X; ++X)
+				{
+					CellPoints[Grid.GetCell(FIntVector(X, Y, Z))].Add(PointIdx);
+				}
+			}
+		}
+	}
+
+	//Each cell looks at the tetrahedra with a vertex of its own. A final one is added by the lowest cell it is final in,
+	//the vertices of the cell with any tetrahedron that isn't go on the border
+	TArray<TArray<FIntVector4>> CellTetrahedra;
+	TArray<TArray<int32>> CellBorderPoints;
+	CellTetrahedra.SetNum(Grid.Num());
+	CellBorderPoints.SetNum(Grid.Num());
+	ParallelFor(Grid.Num(), [&](int32 Cell)
+	{
+		const TArray<int32>& CellPointIndices = CellPoints[Cell];
+		if(CellPointIndices.IsEmpty())
+		{
+			return;
+		}
+
+		TArray<FVector> CellLocations;
+		CellLocations.Reserve(CellPointIndices.Num());
+		for (const int32 PointIdx : CellPointIndices)
+		{
+			CellLocations.Add(Points[PointIdx]);
+		}
+		FDungeonTriangulator Triangulator;
+		Triangulator.Triangulate(CellLocations, SuperBounds);
+
+		for (const FTetrahedron& CellTetra : Triangulator.GetTetrahedra())
+		{
+			if(CellTetra.bIsDead)
+			{
+				continue;
+			}
+
+			const FIntVector4 Tetra = ToPointIndices(Triangulator, CellTetra, CellPointIndices);
+			bool bHasCellVertex = false;
+			for (int32 Vert = 0; Vert < 4; ++Vert)
+			{
+				bHasCellVertex |= !IsSuperVertex(Tetra[Vert]) && PointCells[Tetra[Vert]] == Cell;
+			}
+			if(!bHasCellVertex)
+			{
+				continue;
+			}
+
+			if(!IsFinalInCell(Tetra, Grid, Cell))
+			{
+				for (int32 Vert = 0; Vert < 4; ++Vert)
+				{
+					if(!IsSuperVertex(Tetra[Vert]) && PointCells[Tetra[Vert]] == Cell)
+					{
+						CellBorderPoints[Cell].Add(Tetra[Vert]);
+					}
+				}
+				continue;
+			}
+
+			bool bAddedByLowerCell = false;
+			for (int32 Vert = 0; Vert < 4 && !bAddedByLowerCell; ++Vert)
+			{
+				bAddedByLowerCell = PointCells[Tetra[Vert]] < Cell && IsFinalInCell(Tetra, Grid, PointCells[Tetra[Vert]]);
+			}
+			if(!bAddedByLowerCell)
+			{
+				CellTetrahedra[Cell].Add(Tetra);
+			}
+		}
+	}, EParallelForFlags::Unbalanced);
+
+	int32 NumFinalTetrahedra = 0;
+	TArray<bool> BorderPointMarks;
+	BorderPointMarks.Init(false, Points.Num());
+	for (int32 Cell = 0; Cell < Grid.Num(); ++Cell)
+	{
+		NumFinalTetrahedra += CellTetrahedra[Cell].Num();
+		for (const int32 PointIdx : CellBorderPoints[Cell])
+		{
+			BorderPointMarks[PointIdx] = true;
+		}
+	}
+	OutTetrahedra.Reserve(OutTetrahedra.Num() + NumFinalTetrahedra);
+	for (const TArray<FIntVector4>& Tetras : CellTetrahedra)
+	{
+		OutTetrahedra.Append(Tetras);
+	}
+
+	//Every tetrahedron of the whole subset that no cell added has all its vertices among the border points
+	TArray<int32> BorderPoints;
+	for (const int32 PointIdx : PointIndices)
+	{
+		if(BorderPointMarks[PointIdx])
+		{
+			BorderPoints.Add(PointIdx);
+		}
+	}
+	if(BorderPoints.IsEmpty())
+	{
+		return;
+	}
+	TArray<FIntVector4> BorderTetrahedra;
+	TriangulateSubset(BorderPoints, Depth + 1, BorderTetrahedra);
+
+	//Points left out of the border triangulation next to a border point, keyed like edges from the border point
+	TArray<TArray<uint64>> CellBorderNeighbours;
+	CellBorderNeighbours.SetNum(Grid.Num());
+	ParallelFor(Grid.Num(), [&](int32 Cell)
+	{
+		for (const FIntVector4& Tetra : CellTetrahedra[Cell])
+		{
+			for (int32 Vert = 0; Vert < 4; ++Vert)
+			{
+				for (int32 OtherVert = 0; OtherVert < 4 && BorderPointMarks[Tetra[Vert]]; ++OtherVert)
+				{
+					if(!BorderPointMarks[Tetra[OtherVert]])
+					{
+						CellBorderNeighbours[Cell].Add(static_cast<uint64>(Tetra[Vert]) << 32 | static_cast<uint32>(Tetra[OtherVert]));
+					}
+				}
+			}
+		}
+	});
+	TArray<uint64> BorderNeighbours;
+	for (const TArray<uint64>& Neighbours : CellBorderNeighbours)
+	{
+		BorderNeighbours.Append(Neighbours);
+	}
+	FDungeonTriangulator::SortUniqueEdges(BorderNeighbours);
+
+	//A border tetrahedron is Delaunay for the whole subset unless a left out point falls in its circumsphere, and then
+	//one of those points is next to one of its vertices. The ones final in a cell were added already
+	TArray<bool> KeepBorderTetrahedra;
+	KeepBorderTetrahedra.Init(true, BorderTetrahedra.Num());
+	ParallelFor(BorderTetrahedra.Num(), [&](int32 TetraIdx)
+	{
+		const FIntVector4& Tetra = BorderTetrahedra[TetraIdx];
+		for (int32 Vert = 0; Vert < 4 && KeepBorderTetrahedra[TetraIdx]; ++Vert)
+		{
+			KeepBorderTetrahedra[TetraIdx] = IsSuperVertex(Tetra[Vert]) || !IsFinalInCell(Tetra, Grid, PointCells[Tetra[Vert]]);
+		}
+
+		//InSphere expects a positively oriented tetrahedron
+		int32 Verts[4] = {Tetra[0], Tetra[1], Tetra[2], Tetra[3]};
+		if(DungeonPredicates::Orient(Points[Verts[0]], Points[Verts[1]], Points[Verts[2]], Points[Verts[3]]) < 0.0)
+		{
+			Swap(Verts[0], Verts[1]);
+		}
+		for (int32 Vert = 0; Vert < 4 && KeepBorderTetrahedra[TetraIdx]; ++Vert)
+		{
+			if(IsSuperVertex(Verts[Vert]))
+			{
+				continue;
+			}
+
+			//Binary search for the first key of the vertex
+			const uint64 FirstKey = static_cast<uint64>(Verts[Vert]) << 32;
+			int32 KeyIdx = 0;
+			for (int32 Count = BorderNeighbours.Num(); Count > 0;)
+			{
+				const int32 Half = Count / 2;
+				if(BorderNeighbours[KeyIdx + Half] < FirstKey)
+				{
+					KeyIdx += Half + 1;
+					Count -= Half + 1;
+				}
+				else
+				{
+					Count = Half;
+				}
+			}
+			for (; KeyIdx < BorderNeighbours.Num() && BorderNeighbours[KeyIdx] >> 32 == static_cast<uint64>(Verts[Vert]); ++KeyIdx)
+			{
+				const FVector& Neighbour = Points[static_cast<int32>(BorderNeighbours[KeyIdx] & MAX_uint32)];
+				if(DungeonPredicates::InSphere(Points[Verts[0]], Points[Verts[1]], Points[Verts[2]], Points[Verts[3]], Neighbour) > 0.0)
+				{
+					KeepBorderTetrahedra[TetraIdx] = false;
+					break;
+				}
+			}
+		}
+	}, EParallelForFlags::Unbalanced);
+
+	for (int32 TetraIdx = 0; TetraIdx < BorderTetrahedra.Num(); ++TetraIdx)
+	{
+		if(KeepBorderTetrahedra[TetraIdx])
+		{
+			OutTetrahedra.Add(BorderTetrahedra[TetraIdx]);
+		}
+	}
+}
+
+bool FDungeonParallelTriangulator::IsFinalInCell(const FIntVector4& Tetra, const FCellGrid& Grid, int32 Cell) const
+{
+	const FIntVector CellCoord = Grid.GetCellCoords(Cell);
+	for (int32 Vert = 0; Vert < 4; ++Vert)
+	{
+		if(IsSuperVertex(Tetra[Vert]))
+		{
+			return false;
+		}
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if(!Grid.IsInHalo(Points[Tetra[Vert]][Axis], Axis, CellCoord[Axis]))
+			{
+				return false;
+			}
+		}
+	}
+
+	FVector Center;
+	double RadiusSqr, Tolerance;
+	if(!FCircumSphereTable::ComputeSphere(Points[Tetra[0]], Points[Tetra[1]], Points[Tetra[2]], Points[Tetra[3]], Center, RadiusSqr, Tolerance))
+	{
+		return false;
+	}
+	//The tolerance bounds the error of the squared distance, divided by the radius it bounds the distance
+	const double Radius = FMath::Sqrt(RadiusSqr);
+	const double Reach = Radius * (1.0 + SphereMargin) + Tolerance / Radius;
+	for (int32 SuperVert = NumPoints; SuperVert < Points.Num(); ++SuperVert)
+	{
+		if(FVector::DistSquared(Center, Points[SuperVert]) <= FMath::Square(Reach))
+		{
+			return false;
+		}
+	}
+
+	//Points only exist inside the bounds, so only the part of the sphere overlapping them has to be in the cell halo
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		double OtherAxesDistSqr = 0.0;
+		for (int32 OtherAxis = 0; OtherAxis < 3; ++OtherAxis)
+		{
+			const double Outside = FMath::Max3(Grid.Bounds.Min[OtherAxis] - Center[OtherAxis], Center[OtherAxis] - Grid.Bounds.Max[OtherAxis], 0.0);
+			OtherAxesDistSqr += OtherAxis != Axis ? Outside * Outside : 0.0;
+		}
+		const double HalfChord = FMath::Sqrt(FMath::Max(FMath::Square(Reach) - OtherAxesDistSqr, 0.0));
+		const double Low = FMath::Max(Center[Axis] - HalfChord, Grid.Bounds.Min[Axis]);
+		const double High = FMath::Min(Center[Axis] + HalfChord, Grid.Bounds.Max[Axis]);
+		if(!Grid.IsInHalo(Low, Axis, CellCoord[Axis]) || !Grid.IsInHalo(High, Axis, CellCoord[Axis]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FDungeonParallelTriangulator::TriangulateSerial(TConstArrayView<int32> PointIndices, TArray<FIntVector4>& OutTetrahedra) const
+{
+	TArray<FVector> SubsetLocations;
+	SubsetLocations.Reserve(PointIndices.Num());
+	for (const int32 PointIdx : PointIndices)
+	{
+		SubsetLocations.Add(Points[PointIdx]);
+	}
+	FDungeonTriangulator Triangulator;
+	Triangulator.Triangulate(SubsetLocations, SuperBounds);
+
+	OutTetrahedra.Reserve(OutTetrahedra.Num() + Triangulator.GetNumTetrahedra());
+	for (const FTetrahedron& Tetra : Triangulator.GetTetrahedra())
+	{
+		if(!Tetra.bIsDead)
+		{
+			OutTetrahedra.Add(ToPointIndices(Triangulator, Tetra, PointIndices));
+		}
+	}
+}
+
+FIntVector4 FDungeonParallelTriangulator::ToPointIndices(const FDungeonTriangulator& Triangulator, const FTetrahedron& Tetra, TConstArrayView<int32> PointIndices) const
+{
+	FIntVector4 Result;
+	for (int32 Vert = 0; Vert < 4; ++Vert)
+	{
+		//Every triangulation shares the super vertices, they go after the last point
+		const int32 SubsetVert = Tetra.Verts[Vert];
+		Result[Vert] = Triangulator.IsSuperVertex(SubsetVert) ? NumPoints + SubsetVert - PointIndices.Num() : PointIndices[SubsetVert];
+		for (int32 SortedVert = Vert; SortedVert > 0 && Result[SortedVert - 1] > Result[SortedVert]; --SortedVert)
+		{
+			Swap(Result[SortedVert - 1], Result[SortedVert]);
+		}
+	}
+	return Result;
+}
+
+int32 FDungeonParallelTriangulator::FCellGrid::GetCellCoord(double Coord, int32 Axis) const
+{
+	return static_cast<int32>(FMath::Clamp(FMath::FloorToDouble((Coord - Bounds.Min[Axis]) / CellSize[Axis]), 0.0, Splits[Axis] - 1.0));
+}
+
+bool FDungeonParallelTriangulator::FCellGrid::IsInHalo(double Coord, int32 Axis, int32 CellCoord) const
+{
+	return GetCellCoord(Coord - Halo, Axis) <= CellCoord && CellCoord <= GetCellCoord(Coord + Halo, Axis);
+}
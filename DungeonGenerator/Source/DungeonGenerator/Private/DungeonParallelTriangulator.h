@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FDungeonTriangulator;
+struct FTetrahedron;
+
+/**
+ * 3D Delaunay triangulation split over worker threads, with the same tetrahedra as FDungeonTriangulator for the same
+ * points. The points are bucketed in a grid of cells and every cell is triangulated on its own together with a halo of
+ * points around it, all of them inside the super tetrahedron of the whole set. A tetrahedron whose circumsphere only
+ * reaches points the cell triangulated is final. The few points with tetrahedra that aren't are triangulated again on
+ * their own, and each of those tetrahedra is checked against the points next to it before keeping it.
+ */
+class DUNGEONGENERATOR_API FDungeonParallelTriangulator
+{
+public:
+	//Cells handed to each worker thread, so uneven cells still keep every worker busy
+	static constexpr int32 CellsPerWorker = 4;
+	//Fewest points a cell holds before its halo, smaller cells would be mostly halo
+	static constexpr int32 MinPointsPerCell = 4096;
+	//Point sets smaller than this are triangulated serially. Default room count for the Auto backend to pick this one
+	static constexpr int32 MinParallelPoints = 2 * MinPointsPerCell;
+	//Width of the halo in average distances between points
+	static constexpr double HaloSpacings = 3.0;
+	//Border points are split in cells this many times at most, past that they are triangulated serially
+	static constexpr int32 MaxDepth = 2;
+	//Relative slack added to a circumsphere before checking what it reaches
+	static constexpr double SphereMargin = 1e-9;
+
+	/** Triangulates the points. Four super vertices enclosing them are numbered after the last point. */
+	void Triangulate(TConstArrayView<FVector> InPoints);
+	void Reset();
+
+	/** Tetrahedra as indices into the triangulated points, each with its vertices sorted. */
+	const TArray<FIntVector4>& GetTetrahedra() const { return Tetrahedra; }
+	int32 GetNumTetrahedra() const { return Tetrahedra.Num(); }
+	/** Vertices of the enclosing tetrahedron, not part of the triangulated points. */
+	bool IsSuperVertex(int32 Vert) const { return Vert >= NumPoints; }
+	/** Edges between triangulated points as FDungeonTriangulator::MakeEdge keys, sorted and unique. */
+	void GetEdges(TArray<uint64>& OutEdges) const;
+
+private:
+	/** Grid a subset of the points is bucketed in. Coordinates past the bounds belong to the outer cells. */
+	struct FCellGrid
+	{
+		FBox Bounds = FBox(ForceInit);
+		FVector CellSize = FVector::OneVector;
+		FIntVector Splits = FIntVector(1);
+		//Cells also triangulate the points this far around them
+		double Halo = 0.0;
+
+		int32 Num() const { return Splits.X * Splits.Y * Splits.Z; }
+		int32 GetCellCoord(double Coord, int32 Axis) const;
+		int32 GetCell(const FIntVector& CellCoord) const { return (CellCoord.Z * Splits.Y + CellCoord.Y) * Splits.X + CellCoord.X; }
+		FIntVector GetCellCoords(int32 Cell) const { return FIntVector(Cell % Splits.X, Cell / Splits.X % Splits.Y, Cell / (Splits.X * Splits.Y)); }
+		/** Whether a point at Coord along Axis is triangulated by cells at CellCoord along it. */
+		bool IsInHalo(double Coord, int32 Axis, int32 CellCoord) const;
+	};
+
+	/** Delaunay tetrahedra of the points in PointIndices and the super vertices, with sorted vertices. */
+	void TriangulateSubset(TConstArrayView<int32> PointIndices, int32 Depth, TArray<FIntVector4>& OutTetrahedra) const;
+	void TriangulateSerial(TConstArrayView<int32> PointIndices, TArray<FIntVector4>& OutTetrahedra) const;
+	/** Vertices of a tetrahedron triangulated from the points in PointIndices, as sorted indices into Points. */
+	FIntVector4 ToPointIndices(const FDungeonTriangulator& Triangulator, const FTetrahedron& Tetra, TConstArrayView<int32> PointIndices) const;
+	/** Whether a tetrahedron is Delaunay for the whole subset because every point its circumsphere reaches is
+	 * triangulated by Cell. Only depends on the sorted vertices, so any cell gets the same answer for it. */
+	bool IsFinalInCell(const FIntVector4& Tetra, const FCellGrid& Grid, int32 Cell) const;
+
+	//Triangulated points followed by the super vertices
+	TArray<FVector> Points;
+	int32 NumPoints = 0;
+	FBox SuperBounds = FBox(ForceInit);
+	TArray<FIntVector4> Tetrahedra;
+};
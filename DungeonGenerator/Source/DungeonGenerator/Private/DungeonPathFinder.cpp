@@ -3,87 +3,162 @@
 
 #include "DungeonPathFinder.h"
 
-void UDungeonPathFinder::Initialize(FVector StartPoint, FVector EndLocation)
+#include "DrawDebugHelpers.h"
+#include "DungeonGeneratorStats.h"
+#include "DungeonOccupancyGrid.h"
+
+void FDungeonPathFinder::Initialize(FVector StartPoint, FVector EndLocation)
 {
-	OpenNodes.Empty();
-	ClosedNodes.Empty();
-	OpenNodes.Add(FDungeonPathNode(StartPoint));
+	ResetSearch();
 	PathEndLocation = EndLocation;
+	LatticeOrigin = StartPoint;
+	Search.AddStart(PackCell(FIntVector::ZeroValue), 0.0, FVector::DistSquared(PathEndLocation, StartPoint));
 };
 
-bool UDungeonPathFinder::Evaluate()
+void FDungeonPathFinder::ResetSearch()
 {
-	if(OpenNodes.IsEmpty())
+	Search.Reset();
+	PathResult.Empty();
+	CurrentNode = INDEX_NONE;
+}
+
+bool FDungeonPathFinder::Evaluate()
+{
+	CurrentNode = Search.PopOpen();
+	if(CurrentNode == INDEX_NONE)
 	{
 		return true;
 	}
 	
-	CurrentNode = OpenNodes.Pop();
-	ClosedNodes.Push(CurrentNode);
 	FVector FinalEndLocation;
 	if(HasReachedDestiny(FinalEndLocation))
 	{
-		CurrentNode.NodeLocation = FinalEndLocation;
-		CurrentNode.Path[CurrentNode.Path.Num() - 1] = FinalEndLocation;
-		BuildPath();
+		TArray<FVector> Path;
+		GetCurrentPathLocations(Path);
+		Path.Last() = FinalEndLocation;
+		BuildPath(Path);
 		return true;
 	}
 
-	TArray<FDungeonPathNode> ConnectedNodes;
-	GetConnectedNodes(ConnectedNodes);
-	for(FDungeonPathNode& ConnectedNode : ConnectedNodes)
+	//Copied, relaxing new nodes can move the node arena
+	const FSearchNode PreviousNode = Search.GetNode(CurrentNode);
+	TArray<FIntVector> ConnectedCells;
+	GetConnectedNodes(ConnectedCells);
+	for(const FIntVector& ConnectedCell : ConnectedCells)
 	{
-		if(ClosedNodes.Contains(ConnectedNode))
+		if(!IsCellInRange(ConnectedCell))
 		{
 			continue;
 		}
+		double G, H;
+		FillMetrics(GetCellLocation(ConnectedCell), PreviousNode, G, H);
+		Search.Relax(CurrentNode, PackCell(ConnectedCell), G, H);
+	}
+	return false;
+}
 
-		FillMetrics(ConnectedNode, CurrentNode);
-		int32 NodeIndex = OpenNodes.Find(ConnectedNode);
-		if(NodeIndex != INDEX_NONE && ConnectedNode <= OpenNodes[NodeIndex])
-		{
-			continue;
-		}
-		NodeIndex = ClosedNodes.Find(ConnectedNode);
-		if(NodeIndex != INDEX_NONE)
+bool FDungeonPathFinder::Evaluate(int32 MaxExpansions, double EndTime, int32& Out_Expansions)
+{
+	Out_Expansions = 0;
+	do
+	{
+		++Out_Expansions;
+		if(Evaluate())
 		{
-			continue;
+			return true;
 		}
-		
-		OpenNodes.Push(ConnectedNode);
 	}
-	OpenNodes.Sort();
+	while (Out_Expansions < MaxExpansions && FPlatformTime::Seconds() < EndTime);
 	return false;
 }
 
-void UDungeonPathFinder::Debug(float LifeTime)
+void FDungeonPathFinder::Debug(const UWorld* World, float LifeTime) const
 {
-	for (int i = 0; i < CurrentNode.Path.Num() - 1; ++i)
+	if(CurrentNode == INDEX_NONE)
+	{
+		return;
+	}
+	for (const FSearchNode* Node = &Search.GetNode(CurrentNode); Node->Parent != INDEX_NONE;)
 	{
-		DrawDebugLine(GetWorld(), CurrentNode.Path[i], CurrentNode.Path[i + 1], FColor::Orange, false, LifeTime, 0, 10);
+		const FSearchNode* ParentNode = &Search.GetNode(Node->Parent);
+		DrawDebugLine(World, GetNodeLocation(*ParentNode), GetNodeLocation(*Node), FColor::Orange, false, LifeTime, 0, 10);
+		Node = ParentNode;
 	}
 }
 
-bool UDungeonPathFinder::HasReachedDestiny(FVector& Out_EndLocation) const
+bool FDungeonPathFinder::HasReachedDestiny(FVector& Out_EndLocation) const
+{
+	Out_EndLocation = GetNodeLocation(Search.GetNode(CurrentNode));
+	return Out_EndLocation.Equals(PathEndLocation);
+}
+
+void FDungeonPathFinder::BuildPath(const TArray<FVector>& Path)
+{
+	PathResult = Path;
+}
+
+void FDungeonPathFinder::FillMetrics(const FVector& ForLocation, const FSearchNode& PreviousNode, double& Out_G, double& Out_H) const
+{
+	Out_G = PreviousNode.G + FVector::DistSquared(GetNodeLocation(PreviousNode), ForLocation);
+	Out_H = FVector::DistSquared(PathEndLocation, ForLocation);
+}
+
+void FDungeonPathFinder::AccumulateStats() const
+{
+	INC_DWORD_STAT_BY(STAT_PathFinderOpenNodes, Search.GetNumOpen());
+	INC_DWORD_STAT_BY(STAT_PathFinderClosedNodes, Search.GetNumClosed());
+}
+
+void FDungeonPathFinder::GetCurrentPathLocations(TArray<FVector>& Out_Locations) const
+{
+	Out_Locations.Reset();
+	if(CurrentNode == INDEX_NONE)
+	{
+		return;
+	}
+	TArray<uint64> PathKeys;
+	Search.GetPath(CurrentNode, PathKeys);
+	Out_Locations.Reserve(PathKeys.Num());
+	for (const uint64 PathKey : PathKeys)
+	{
+		Out_Locations.Add(GetCellLocation(UnpackCell(PathKey)));
+	}
+}
+
+uint64 FDungeonPathFinder::PackCell(const FIntVector& Cell)
+{
+	//Each axis is biased to unsigned and gets its own bits
+	constexpr uint64 AxisMask = (uint64(1) << CellAxisBits) - 1;
+	const uint64 X = static_cast<uint64>(Cell.X + MaxCellCoord) & AxisMask;
+	const uint64 Y = static_cast<uint64>(Cell.Y + MaxCellCoord) & AxisMask;
+	const uint64 Z = static_cast<uint64>(Cell.Z + MaxCellCoord) & AxisMask;
+	return (Z << (CellAxisBits * 2)) | (Y << CellAxisBits) | X;
+}
+
+FIntVector FDungeonPathFinder::UnpackCell(uint64 Key)
 {
-	Out_EndLocation = CurrentNode.NodeLocation;
-	return CurrentNode.NodeLocation.Equals(PathEndLocation);
+	constexpr uint64 AxisMask = (uint64(1) << CellAxisBits) - 1;
+	return FIntVector(static_cast<int32>(Key & AxisMask) - MaxCellCoord
+		, static_cast<int32>((Key >> CellAxisBits) & AxisMask) - MaxCellCoord
+		, static_cast<int32>((Key >> (CellAxisBits * 2)) & AxisMask) - MaxCellCoord);
 }
 
-void UDungeonPathFinder::BuildPath()
+bool FDungeonPathFinder::IsCellInRange(const FIntVector& Cell)
 {
-	PathResult = CurrentNode.Path;
+	return FMath::Abs(Cell.X) <= MaxCellCoord && FMath::Abs(Cell.Y) <= MaxCellCoord && FMath::Abs(Cell.Z) <= MaxCellCoord;
 }
 
-void UDungeonPathFinder::FillMetrics(FDungeonPathNode& ForNode, const FDungeonPathNode& PreviousNode)
+FVector FDungeonPathFinder::GetCellLocation(const FIntVector& Cell) const
 {
-	ForNode.G = PreviousNode.G + FVector::DistSquared(PreviousNode.NodeLocation, ForNode.NodeLocation);
-	ForNode.H = FVector::DistSquared(PathEndLocation, ForNode.NodeLocation);
-	ForNode.F = ForNode.G + ForNode.H;
+	return LatticeOrigin + FVector(Cell.X, Cell.Y, Cell.Z) * LatticeCellSize;
 }
 
-UDungeonHallwayPathFinder::UDungeonHallwayPathFinder()
-	: Super()
+FDungeonHallwayPathFinder::FDungeonHallwayPathFinder()
+	: PathStartLocation(FVector::ZeroVector)
+	, StartRoomExtent(FVector::ZeroVector)
+	, EndRoomExtent(FVector::ZeroVector)
+	, MaxSlopeAngle(45.0f)
+	, HallWaySegmentLength(0.0f)
 {
 	CoreValidConnectionDirection.Add(FVector::ForwardVector);
 	CoreValidConnectionDirection.Add(FVector::BackwardVector);
@@ -94,84 +169,82 @@ UDungeonHallwayPathFinder::UDungeonHallwayPathFinder()
 	CoreValidConnectionDirection.Add((FVector::ForwardVector + FVector::LeftVector).GetSafeNormal());
 	CoreValidConnectionDirection.Add((FVector::BackwardVector + FVector::RightVector).GetSafeNormal());
 }
-void UDungeonHallwayPathFinder::Initialize(FVector StartPoint, FVector EndLocation)
+void FDungeonHallwayPathFinder::Initialize(FVector StartPoint, FVector EndLocation)
 {
-	OpenNodes.Empty();
-	ClosedNodes.Empty();
+	ResetSearch();
 	PathEndLocation = EndLocation;
-		
-	OpenNodes.Add(FDungeonPathNode(StartPoint + CoreValidConnectionDirection[0] * (StartRoomExtent*2.0f)));
-	OpenNodes.Last().G = 0;
-	OpenNodes.Last().H = FVector::DistSquared(PathEndLocation, OpenNodes.Last().NodeLocation);
-	OpenNodes.Last().F = OpenNodes.Last().G + OpenNodes.Last().H;
-					
-	OpenNodes.Add(FDungeonPathNode(StartPoint + CoreValidConnectionDirection[1] * (StartRoomExtent*2.0f)));
-	OpenNodes.Last().G = 0;
-	OpenNodes.Last().H = FVector::DistSquared(PathEndLocation, OpenNodes.Last().NodeLocation);
-	OpenNodes.Last().F = OpenNodes.Last().G + OpenNodes.Last().H;
-					
-	OpenNodes.Add(FDungeonPathNode(StartPoint + CoreValidConnectionDirection[2] * (StartRoomExtent*2.0f)));
-	OpenNodes.Last().G = 0;
-	OpenNodes.Last().H = FVector::DistSquared(PathEndLocation, OpenNodes.Last().NodeLocation);
-	OpenNodes.Last().F = OpenNodes.Last().G + OpenNodes.Last().H;
-					
-	OpenNodes.Add(FDungeonPathNode(StartPoint + CoreValidConnectionDirection[3] * (StartRoomExtent*2.0f)));
-	OpenNodes.Last().G = 0;
-	OpenNodes.Last().H = FVector::DistSquared(PathEndLocation, OpenNodes.Last().NodeLocation);
-	OpenNodes.Last().F = OpenNodes.Last().G + OpenNodes.Last().H;
-	OpenNodes.Sort();
+	LatticeOrigin = StartPoint;
+	for (int i = 0; i < 4; ++i)
+	{
+		//Start cells are rounded away from the room so they stay twice its extent away from the center
+		const FVector StartOffset = CoreValidConnectionDirection[i] * (StartRoomExtent*2.0f);
+		const FIntVector StartCell(FMath::CeilToInt(FMath::Abs(StartOffset.X) / LatticeCellSize.X) * (StartOffset.X < 0 ? -1 : 1)
+			, FMath::CeilToInt(FMath::Abs(StartOffset.Y) / LatticeCellSize.Y) * (StartOffset.Y < 0 ? -1 : 1)
+			, 0);
+		Search.AddStart(PackCell(StartCell), 0.0, FVector::DistSquared(PathEndLocation, GetCellLocation(StartCell)));
+	}
 }
 
-void UDungeonHallwayPathFinder::Debug(float LifeTime)
+void FDungeonHallwayPathFinder::Debug(const UWorld* World, float LifeTime) const
 {
-	Super::Debug(LifeTime);
+	FDungeonPathFinder::Debug(World, LifeTime);
 	// for (int i = 0; i < CoreValidConnectionDirection.Num(); ++i)
 	// {
 	// 	DrawDebugDirectionalArrow(GetWorld(), CurrentNode.NodeLocation, CurrentNode.NodeLocation + CoreValidConnectionDirection[i] * HallWaySegmentLength, 10, FColor::Magenta, false, LifeTime * 2.0f);
 	// }
 }
 
-void UDungeonHallwayPathFinder::FillAdditionalValidConnectionDirections(FVector StartPoint, FVector EndLocation)
+void FDungeonHallwayPathFinder::FillAdditionalValidConnectionDirections(FVector StartPoint, FVector EndLocation)
 {
-	ValidConnectionDirection.Empty(ValidConnectionDirection.Num());
+	ValidConnectionMoves.Empty(ValidConnectionMoves.Num());
 
 	FVector ExpectedDirection = (EndLocation - StartPoint).GetSafeNormal();
 	FVector ProjectedDirection = ExpectedDirection.GetSafeNormal2D();
 
 	float Angle = FMath::RadiansToDegrees(FMath::Acos(FVector::DotProduct(ExpectedDirection, ProjectedDirection)));
-	Angle = FMath::Min(MaxSlopeAngle, Angle);
-		
-	// vertical Diagonals
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[0].RotateAngleAxis(Angle,  CoreValidConnectionDirection[2]));// FVector::ForwardVector + FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[1].RotateAngleAxis(Angle,  CoreValidConnectionDirection[2])); //(FVector::BackwardVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[0].RotateAngleAxis(Angle,  CoreValidConnectionDirection[3])); //(FVector::ForwardVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[1].RotateAngleAxis(Angle,  CoreValidConnectionDirection[3])); //(FVector::BackwardVector + FVector::UpVector).GetSafeNormal();
-	
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[2].RotateAngleAxis(Angle, CoreValidConnectionDirection[0])); //(FVector::RightVector + FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[3].RotateAngleAxis(Angle, CoreValidConnectionDirection[0])); //(FVector::LeftVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[2].RotateAngleAxis(Angle, CoreValidConnectionDirection[1])); //(FVector::RightVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[3].RotateAngleAxis(Angle, CoreValidConnectionDirection[1])); //(FVector::LeftVector + FVector::UpVector).GetSafeNormal();
+	Angle = FMath::Min(MaxSlopeAngle, FMath::CeilToInt(Angle / SlopeBucketDegrees) * SlopeBucketDegrees);
+
+	//A horizontal step is one segment, a vertical one is what a segment climbs at the bucketed slope
+	const float CellHeight = HallWaySegmentLength * FMath::Tan(FMath::DegreesToRadians(Angle));
+	const bool bIsFlat = CellHeight <= KINDA_SMALL_NUMBER;
+	LatticeCellSize = FVector(HallWaySegmentLength, HallWaySegmentLength, bIsFlat ? HallWaySegmentLength : CellHeight);
+
+	//F,B,R,L and horizontal diagonals
+	for (int32 Y = -1; Y <= 1; ++Y)
+	{
+		for (int32 X = -1; X <= 1; ++X)
+		{
+			if(X != 0 || Y != 0)
+			{
+				ValidConnectionMoves.Add(FIntVector(X, Y, 0));
+			}
+		}
+	}
+	if(bIsFlat)
+	{
+		return;
+	}
 	
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[4].RotateAngleAxis(Angle, CoreValidConnectionDirection[6])); //(FVector::ForwardVector + FVector::RightVector + FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[7].RotateAngleAxis(Angle, CoreValidConnectionDirection[4])); //(FVector::BackwardVector + FVector::LeftVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[4].RotateAngleAxis(Angle, CoreValidConnectionDirection[7])); //(FVector::ForwardVector + FVector::RightVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[7].RotateAngleAxis(Angle, CoreValidConnectionDirection[5])); //(FVector::BackwardVector + FVector::LeftVector + FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[5].RotateAngleAxis(Angle, CoreValidConnectionDirection[7])); //(FVector::ForwardVector + FVector::LeftVector + FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[6].RotateAngleAxis(Angle, CoreValidConnectionDirection[5])); //(FVector::BackwardVector + FVector::RightVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[5].RotateAngleAxis(Angle, CoreValidConnectionDirection[6])); //(FVector::ForwardVector + FVector::LeftVector - FVector::UpVector).GetSafeNormal();
-	ValidConnectionDirection.Add(CoreValidConnectionDirection[6].RotateAngleAxis(Angle, CoreValidConnectionDirection[4])); //(FVector::BackwardVector + FVector::RightVector + FVector::UpVector).GetSafeNormal();
+	// vertical Diagonals
+	for (int32 FlatMove = 0; FlatMove < 8; ++FlatMove)
+	{
+		ValidConnectionMoves.Add(ValidConnectionMoves[FlatMove] + FIntVector(0, 0, 1));
+		ValidConnectionMoves.Add(ValidConnectionMoves[FlatMove] - FIntVector(0, 0, 1));
+	}
 }
 
-bool UDungeonHallwayPathFinder::HasReachedDestiny(FVector& Out_EndLocation) const
+bool FDungeonHallwayPathFinder::HasReachedDestiny(FVector& Out_EndLocation) const
 {
 	Out_EndLocation = FVector::ZeroVector;
-	if(CurrentNode.Path.Num() < 2)
+	const FSearchNode& Node = Search.GetNode(CurrentNode);
+	if(Node.Parent == INDEX_NONE)
 	{
 		return false;
 	}
+	const FVector PreviousLocation = GetNodeLocation(Search.GetNode(Node.Parent));
 	
 	FBox Room = FBox(PathEndLocation - (EndRoomExtent+FVector(HallWaySegmentLength, HallWaySegmentLength, 0)), PathEndLocation + (EndRoomExtent+FVector(HallWaySegmentLength, HallWaySegmentLength, 0)));
-	if(Room.IsInside(CurrentNode.Path.Last(1)))
+	if(Room.IsInside(PreviousLocation))
 	{
 		return false;
 	}
@@ -180,7 +253,7 @@ bool UDungeonHallwayPathFinder::HasReachedDestiny(FVector& Out_EndLocation) cons
 	{
 		FPlane PlaneToCheck(PathEndLocation + CoreValidConnectionDirection[i]*(EndRoomExtent+HallWaySegmentLength), CoreValidConnectionDirection[i]);
 		
-		const bool PlaneIntersecting = FMath::SegmentPlaneIntersection(CurrentNode.Path.Last(1), CurrentNode.NodeLocation, PlaneToCheck, Out_EndLocation);
+		const bool PlaneIntersecting = FMath::SegmentPlaneIntersection(PreviousLocation, GetNodeLocation(Node), PlaneToCheck, Out_EndLocation);
 
 		FVector NegatedDirection(!CoreValidConnectionDirection[i].X, !CoreValidConnectionDirection[i].Y, 0);
 		FVector2D PlaneSize(NegatedDirection.GetAbs()*EndRoomExtent);
@@ -195,7 +268,6 @@ bool UDungeonHallwayPathFinder::HasReachedDestiny(FVector& Out_EndLocation) cons
 			// DrawDebugPoint(GetWorld(),Out_EndLocation, 10.0f, FColor::Magenta, false,  );
 			if(Room.IsInsideOrOn(Out_EndLocation))
 			{
-				DrawDebugPoint(GetWorld(), Out_EndLocation, 10.0f, FColor::Green, true);
 				//Out_EndLocation += (-CoreValidConnectionDirection[i])*HallWaySegmentLength;
 				return true;
 			}
@@ -205,60 +277,58 @@ bool UDungeonHallwayPathFinder::HasReachedDestiny(FVector& Out_EndLocation) cons
 	return false;
 }
 
-void UDungeonHallwayPathFinder::BuildPath()
+void FDungeonHallwayPathFinder::BuildPath(const TArray<FVector>& Path)
 {
 	TArray<FVector> FinalPath;
 	const FBox StartRoom = FBox(PathStartLocation - StartRoomExtent, PathStartLocation + StartRoomExtent);
-	FinalPath.Add(StartRoom.GetClosestPointTo(CurrentNode.Path[0]));
-	for (int i = 0; i < CurrentNode.Path.Num() - 1; i = i + 2)
+	FinalPath.Add(StartRoom.GetClosestPointTo(Path[0]));
+	for (int i = 0; i < Path.Num() - 1; i = i + 2)
 	{
-		FinalPath.Add(CurrentNode.Path[i]);
+		FinalPath.Add(Path[i]);
 	}
 	
 
-	if(FVector::Dist(CurrentNode.Path.Last(), FinalPath.Last()) > HallWaySegmentLength)
+	if(FVector::Dist(Path.Last(), FinalPath.Last()) > HallWaySegmentLength)
 	{
-		FinalPath.Add(CurrentNode.Path.Last());
+		FinalPath.Add(Path.Last());
 	}
 	FBox EndRoom = FBox(PathEndLocation - (EndRoomExtent), PathEndLocation + EndRoomExtent);
-	FVector ConectingPoint = EndRoom.GetClosestPointTo(CurrentNode.Path.Last());
+	FVector ConectingPoint = EndRoom.GetClosestPointTo(Path.Last());
 	FinalPath.Last().Z = ConectingPoint.Z;
 	FinalPath.Add(ConectingPoint);
 	PathResult = FinalPath;
 }
 
-void UDungeonHallwayPathFinder::GetConnectedNodes(TArray<FDungeonPathNode>& Connections) const
+void FDungeonHallwayPathFinder::GetConnectedNodes(TArray<FIntVector>& Connections) const
 {
 	Connections.Empty();
 	FBox Room = FBox(PathEndLocation - (EndRoomExtent + HallWaySegmentLength), PathEndLocation + (EndRoomExtent+FVector(HallWaySegmentLength, HallWaySegmentLength, 0)));
 	Room = Room.ExpandBy(FVector(0, 0, FLT_MAX));
-	if(Room.IsInsideOrOn(CurrentNode.NodeLocation))
+	const FIntVector CurrentCell = UnpackCell(Search.GetNode(CurrentNode).State);
+	if(Room.IsInsideOrOn(GetCellLocation(CurrentCell)))
 	{
 		return;
 	}
 	Room = Room.ExpandBy(FVector(-HallWaySegmentLength, -HallWaySegmentLength, 0));
-	for (int i = 0; i < CoreValidConnectionDirection.Num(); ++i)
+	const FVector CurrentLocation = GetCellLocation(CurrentCell);
+	for (const FIntVector& Move : ValidConnectionMoves)
 	{
-		const FVector ValidDirection = CurrentNode.NodeLocation + CoreValidConnectionDirection[i] * HallWaySegmentLength;
-		if(Room.IsInside(ValidDirection))
+		const FIntVector ConnectedCell = CurrentCell + Move;
+		const FVector ConnectedLocation = GetCellLocation(ConnectedCell);
+		if(Room.IsInside(ConnectedLocation) || IsObstacle(ConnectedLocation))
 		{
 			continue;
 		}
-		Connections.Add(FDungeonPathNode(CurrentNode, ValidDirection));
-	}
-	
-	for (int i = 0; i < ValidConnectionDirection.Num(); ++i)
-	{
-		const FVector ValidDirection = CurrentNode.NodeLocation + ValidConnectionDirection[i] * HallWaySegmentLength;
-		if(Room.IsInside(ValidDirection))
+		//The middle of the move too, a diagonal one can slip between the cells of a hallway it crosses
+		if(bBlockHallways && (IsInOtherHallway(ConnectedLocation) || IsInOtherHallway((CurrentLocation + ConnectedLocation) * 0.5)))
 		{
 			continue;
 		}
-		Connections.Add(FDungeonPathNode(CurrentNode, ValidDirection));
+		Connections.Add(ConnectedCell);
 	}
 }
 
-void UDungeonHallwayPathFinder::FillMetrics(FDungeonPathNode& ForNode, const FDungeonPathNode& PreviousNode)
+void FDungeonHallwayPathFinder::FillMetrics(const FVector& ForLocation, const FSearchNode& PreviousNode, double& Out_G, double& Out_H) const
 {
 	FBox EndRoom = FBox(PathEndLocation - (EndRoomExtent), PathEndLocation + EndRoomExtent);
 
@@ -268,14 +338,44 @@ void UDungeonHallwayPathFinder::FillMetrics(FDungeonPathNode& ForNode, const FDu
 	for (int i = 0; i < 4; ++i)
 	{
 		FVector ExitPoint =  PathEndLocation + CoreValidConnectionDirection[i] * EndRoomExtent;
-		float Distance = FVector::Dist(ForNode.NodeLocation, ExitPoint);
+		float Distance = FVector::Dist(ForLocation, ExitPoint);
 		if(ClosestDistance > Distance)
 		{
 			ClosesPoint = ExitPoint;
 		}
 	}
 	
-	ForNode.G = PreviousNode.G + FVector::DistSquared(PreviousNode.NodeLocation, ForNode.NodeLocation) + ForNode.Path.Num();
-	ForNode.H = FVector::DistSquared(ClosesPoint, ForNode.NodeLocation);
-	ForNode.F = ForNode.G + ForNode.H;
+	//Depth of the new node adds a small cost per segment
+	Out_G = PreviousNode.G + FVector::DistSquared(GetNodeLocation(PreviousNode), ForLocation) + (PreviousNode.Depth + 1);
+	Out_H = FVector::DistSquared(ClosesPoint, ForLocation);
+	if(!bBlockHallways && IsInOtherHallway(ForLocation))
+	{
+		Out_G += HallwayOverlapCost * FMath::Square(HallWaySegmentLength);
+	}
+}
+
+bool FDungeonHallwayPathFinder::IsObstacle(const FVector& Location) const
+{
+	if(!RoomOccupancy || !RoomOccupancy->IsOccupied(Location))
+	{
+		return false;
+	}
+	//The grid doesn't tell rooms apart, the ones being connected are left out here
+	const FBox StartRoom(PathStartLocation - (StartRoomExtent + RoomObstacleMargin), PathStartLocation + (StartRoomExtent + RoomObstacleMargin));
+	const FBox EndRoom(PathEndLocation - (EndRoomExtent + RoomObstacleMargin), PathEndLocation + (EndRoomExtent + RoomObstacleMargin));
+	return !StartRoom.IsInside(Location) && !EndRoom.IsInside(Location);
+}
+
+bool FDungeonHallwayPathFinder::IsInOtherHallway(const FVector& Location) const
+{
+	return HallwayOccupancy && HallwayOccupancy->IsOccupied(Location)
+		&& !GetConnectedRoomArea(PathStartLocation, StartRoomExtent, HallWaySegmentLength).IsInsideOrOn(Location)
+		&& !GetConnectedRoomArea(PathEndLocation, EndRoomExtent, HallWaySegmentLength).IsInsideOrOn(Location);
+}
+
+FBox FDungeonHallwayPathFinder::GetConnectedRoomArea(const FVector& RoomLocation, const FVector& RoomExtent, float SegmentLength)
+{
+	//Start cells are twice the extent away from the room center, rounded up to a whole segment
+	const FVector AreaExtent = RoomExtent * 2.0f + FVector(SegmentLength, SegmentLength, 0.0f);
+	return FBox(RoomLocation - AreaExtent, RoomLocation + AreaExtent);
 }
@@ -3,95 +3,98 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "DungeonPathFinder.generated.h"
+#include "DungeonAStar.h"
 
-struct FDungeonPathNode
-{
-	FVector NodeLocation = FVector::ZeroVector;
-	TArray<FVector> Path;
-	float G = 0;
-	float F = 0;
-	float H = 0;
-
-	FDungeonPathNode(){}
-	
-	FDungeonPathNode(FVector InNodeLocation)
-		: NodeLocation(InNodeLocation)
-	{
-		Path.Add(NodeLocation);
-	}
-
-	FDungeonPathNode(const FDungeonPathNode& Node, FVector InNodeLocation)
-	{
-		NodeLocation = InNodeLocation;
-		for (const FVector& PathNode : Node.Path)
-		{
-			Path.Add(PathNode);
-		}
-		Path.Add(InNodeLocation);
-	}
-		
-	bool operator==(const FDungeonPathNode& Other) const
-	{
-		const bool SameLocation = NodeLocation.Equals(Other.NodeLocation);
-		const bool SameMetrics = G == Other.G && F == Other.F;
-		return SameLocation && SameMetrics;
-	}
-
-	bool operator <(const FDungeonPathNode& Other) const
-	{
-		return F > Other.F;
-	}
-	bool operator <=(const FDungeonPathNode& Other) const
-	{
-		return F >= Other.F;
-	}
-};
+class FDungeonOccupancyGrid;
 
-UCLASS(Abstract)
-class UDungeonPathFinder : public UObject
+/**
+ * Path finders search an integer lattice of cells laid from LatticeOrigin with LatticeCellSize, each cell keyed by its
+ * coordinates packed in 64 bits. A cell is the same node however it is reached, so revisits are found by key.
+ */
+class FDungeonPathFinder
 {
-	GENERATED_BODY()
 public:
+	typedef TDungeonAStar<uint64>::FNode FSearchNode;
+	//Bits per packed axis, cells can be a million steps away from the origin each way
+	static constexpr int32 CellAxisBits = 21;
+	static constexpr int32 MaxCellCoord = (1 << (CellAxisBits - 1)) - 1;
+	
+	virtual ~FDungeonPathFinder() {}
 	virtual void Initialize(FVector StartPoint, FVector EndLocation);
 	
+	/** Expands one node. Returns true once the search is over, with PathResult empty if no path was found. */
 	bool Evaluate();
-	virtual void Debug(float LifeTime = -1.0f);
+	/** Expands nodes until the search is over, MaxExpansions were expanded or FPlatformTime::Seconds() reaches EndTime.
+	 * At least one node is expanded. Returns true once the search is over. */
+	bool Evaluate(int32 MaxExpansions, double EndTime, int32& Out_Expansions);
+	virtual void Debug(const UWorld* World, float LifeTime = -1.0f) const;
+
+	static uint64 PackCell(const FIntVector& Cell);
+	static FIntVector UnpackCell(uint64 Key);
+	static bool IsCellInRange(const FIntVector& Cell);
+	FVector GetCellLocation(const FIntVector& Cell) const;
+	FVector GetNodeLocation(const FSearchNode& Node) const { return GetCellLocation(UnpackCell(Node.State)); }
+	/** Adds the open and closed nodes of the search to the path finder stats. Called once the search is over. */
+	void AccumulateStats() const;
+	/** Lattice locations from the search start to the node being evaluated, the whole path once one is found. */
+	void GetCurrentPathLocations(TArray<FVector>& Out_Locations) const;
 private:
 	virtual bool HasReachedDestiny(FVector& Out_EndLocation) const;
-	virtual void BuildPath();
-	virtual void GetConnectedNodes(TArray<FDungeonPathNode>& Connections) const {};
-	virtual void FillMetrics(FDungeonPathNode& ForNode, const FDungeonPathNode& PreviousNode);
+	virtual void BuildPath(const TArray<FVector>& Path);
+	virtual void GetConnectedNodes(TArray<FIntVector>& Connections) const {};
+	virtual void FillMetrics(const FVector& ForLocation, const FSearchNode& PreviousNode, double& Out_G, double& Out_H) const;
 public:
 	TArray<FVector> PathResult;
 	
 protected:
+	void ResetSearch();
+	
 	FVector PathEndLocation;
-	TArray<FDungeonPathNode> OpenNodes;
-	TArray<FDungeonPathNode> ClosedNodes;
-	FDungeonPathNode CurrentNode;
+	FVector LatticeOrigin = FVector::ZeroVector;
+	FVector LatticeCellSize = FVector::OneVector;
+	TDungeonAStar<uint64> Search;
+	//Node being evaluated, its parents are the path to it
+	int32 CurrentNode = INDEX_NONE;
 };
 
-UCLASS()
-class UDungeonHallwayPathFinder : public UDungeonPathFinder
+class FDungeonHallwayPathFinder : public FDungeonPathFinder
 {
-	GENERATED_BODY()
 public:
-	UDungeonHallwayPathFinder();
+	//Slopes are rounded up to a multiple of this, so connections with close slopes share their lattice height
+	static constexpr float SlopeBucketDegrees = 5.0f;
+	//Extra cost of a node inside an existing hallway, in squared segment lengths. Only when they don't block the search
+	static constexpr float HallwayOverlapCost = 8.0f;
+	
+	FDungeonHallwayPathFinder();
+	/** Area around a room its hallways leave from and arrive at. Every hallway of the room goes through it, so they can
+	 * share it. */
+	static FBox GetConnectedRoomArea(const FVector& RoomLocation, const FVector& RoomExtent, float SegmentLength);
 	virtual void Initialize(FVector StartPoint, FVector EndLocation) override;
+	/** Sets the lattice cell height from the slope between the rooms and the moves between cells. */
 	void FillAdditionalValidConnectionDirections(FVector StartPoint, FVector EndLocation);
-	virtual void Debug(float LifeTime = -1.0f) override;
+	virtual void Debug(const UWorld* World, float LifeTime = -1.0f) const override;
 private:
 	virtual bool HasReachedDestiny(FVector& Out_EndLocation) const override;
-	virtual void BuildPath() override;
-	virtual void GetConnectedNodes(TArray<FDungeonPathNode>& Connections) const override;
-	virtual void FillMetrics(FDungeonPathNode& ForNode, const FDungeonPathNode& PreviousNode) override;
+	virtual void BuildPath(const TArray<FVector>& Path) override;
+	virtual void GetConnectedNodes(TArray<FIntVector>& Connections) const override;
+	virtual void FillMetrics(const FVector& ForLocation, const FSearchNode& PreviousNode, double& Out_G, double& Out_H) const override;
+	bool IsObstacle(const FVector& Location) const;
+	/** Whether the location is inside a created hallway, outside the areas of the rooms being connected. */
+	bool IsInOtherHallway(const FVector& Location) const;
 public:
 	TArray<FVector> CoreValidConnectionDirection;
-	TArray<FVector> ValidConnectionDirection;
+	//Cell offsets a hallway segment can take, flat ones first
+	TArray<FIntVector> ValidConnectionMoves;
 	FVector PathStartLocation;
 	FVector StartRoomExtent;
 	FVector EndRoomExtent;
 	float MaxSlopeAngle;
 	float HallWaySegmentLength;
+	//Rooms grown by RoomObstacleMargin that hallways route around, the start and end rooms excluded. Null to go anywhere
+	const FDungeonOccupancyGrid* RoomOccupancy = nullptr;
+	FVector RoomObstacleMargin = FVector::ZeroVector;
+	//Hallways created before this one, null to ignore them. Away from the connected rooms they block the search, or only
+	//cost HallwayOverlapCost when bBlockHallways is false
+	const FDungeonOccupancyGrid* HallwayOccupancy = nullptr;
+	bool bBlockHallways = true;
 };
\ No newline at end of file
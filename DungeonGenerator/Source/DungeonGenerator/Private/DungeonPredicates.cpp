@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonPredicates.h"
+
+namespace DungeonPredicates
+{
+	//Dekker's splitter for 53 bit mantissas
+	constexpr double Splitter = 134217729.0;
+
+	/** Exact value as a sum of non overlapping doubles, smallest magnitude first. */
+	using FExpansion = TArray<double, TInlineAllocator<32>>;
+
+	static void TwoSum(double A, double B, double& OutSum, double& OutError)
+	{
+		OutSum = A + B;
+		const double BVirtual = OutSum - A;
+		const double AVirtual = OutSum - BVirtual;
+		OutError = (A - AVirtual) + (B - BVirtual);
+	}
+
+	static void Split(double A, double& OutHigh, double& OutLow)
+	{
+		const double Big = Splitter * A;
+		OutHigh = Big - (Big - A);
+		OutLow = A - OutHigh;
+	}
+
+	static void TwoProduct(double A, double B, double& OutProduct, double& OutError)
+	{
+		OutProduct = A * B;
+		double AHigh, ALow, BHigh, BLow;
+		Split(A, AHigh, ALow);
+		Split(B, BHigh, BLow);
+		OutError = ALow * BLow - (((OutProduct - AHigh * BHigh) - ALow * BHigh) - AHigh * BLow);
+	}
+
+	static FExpansion Difference(double A, double B)
+	{
+		double Sum, Error;
+		TwoSum(A, -B, Sum, Error);
+		FExpansion Result;
+		if(Error != 0.0)
+		{
+			Result.Add(Error);
+		}
+		if(Sum != 0.0)
+		{
+			Result.Add(Sum);
+		}
+		return Result;
+	}
+
+	/** Adds a double to an expansion, dropping zero components. */
+	static void Grow(FExpansion& InOutE, double B)
+	{
+		FExpansion Result;
+		double Q = B;
+		for (const double Component : InOutE)
+		{
+			double Sum, Error;
+			TwoSum(Q, Component, Sum, Error);
+			Q = Sum;
+			if(Error != 0.0)
+			{
+				Result.Add(Error);
+			}
+		}
+		if(Q != 0.0 || Result.IsEmpty())
+		{
+			Result.Add(Q);
+		}
+		InOutE = MoveTemp(Result);
+	}
+
+	static FExpansion Add(const FExpansion& E, const FExpansion& F)
+	{
+		FExpansion Result = E;
+		for (const double Component : F)
+		{
+			Grow(Result, Component);
+		}
+		return Result;
+	}
+
+	static FExpansion Negate(const FExpansion& E)
+	{
+		FExpansion Result = E;
+		for (double& Component : Result)
+		{
+			Component = -Component;
+		}
+		return Result;
+	}
+
+	static FExpansion Scale(const FExpansion& E, double B)
+	{
+		FExpansion Result;
+		for (const double Component : E)
+		{
+			double Product, Error;
+			TwoProduct(Component, B, Product, Error);
+			Grow(Result, Error);
+			Grow(Result, Product);
+		}
+		return Result;
+	}
+
+	static FExpansion Multiply(const FExpansion& E, const FExpansion& F)
+	{
+		FExpansion Result;
+		for (const double Component : F)
+		{
+			Result = Add(Result, Scale(E, Component));
+		}
+		return Result;
+	}
+
+	/** The largest component carries the sign of the whole expansion. */
+	static double Estimate(const FExpansion& E)
+	{
+		return E.IsEmpty() ? 0.0 : E.Last();
+	}
+
+	static FExpansion CrossTerm(const FExpansion& A, const FExpansion& B, const FExpansion& C, const FExpansion& D)
+	{
+		//A * B - C * D
+		return Add(Multiply(A, B), Negate(Multiply(C, D)));
+	}
+
+	double OrientExact(const FVector& A, const FVector& B, const FVector& C, const FVector& D)
+	{
+		const FExpansion ADX = Difference(A.X, D.X), ADY = Difference(A.Y, D.Y), ADZ = Difference(A.Z, D.Z);
+		const FExpansion BDX = Difference(B.X, D.X), BDY = Difference(B.Y, D.Y), BDZ = Difference(B.Z, D.Z);
+		const FExpansion CDX = Difference(C.X, D.X), CDY = Difference(C.Y, D.Y), CDZ = Difference(C.Z, D.Z);
+
+		const FExpansion Det = Add(Add(
+			Multiply(ADZ, CrossTerm(BDX, CDY, CDX, BDY)),
+			Multiply(BDZ, CrossTerm(CDX, ADY, ADX, CDY))),
+			Multiply(CDZ, CrossTerm(ADX, BDY, BDX, ADY)));
+		return -Estimate(Det);
+	}
+
+	double InSphereExact(const FVector& A, const FVector& B, const FVector& C, const FVector& D, const FVector& E)
+	{
+		const FExpansion AEX = Difference(A.X, E.X), AEY = Difference(A.Y, E.Y), AEZ = Difference(A.Z, E.Z);
+		const FExpansion BEX = Difference(B.X, E.X), BEY = Difference(B.Y, E.Y), BEZ = Difference(B.Z, E.Z);
+		const FExpansion CEX = Difference(C.X, E.X), CEY = Difference(C.Y, E.Y), CEZ = Difference(C.Z, E.Z);
+		const FExpansion DEX = Difference(D.X, E.X), DEY = Difference(D.Y, E.Y), DEZ = Difference(D.Z, E.Z);
+
+		const FExpansion AB = CrossTerm(AEX, BEY, BEX, AEY);
+		const FExpansion BC = CrossTerm(BEX, CEY, CEX, BEY);
+		const FExpansion CD = CrossTerm(CEX, DEY, DEX, CEY);
+		const FExpansion DA = CrossTerm(DEX, AEY, AEX, DEY);
+		const FExpansion AC = CrossTerm(AEX, CEY, CEX, AEY);
+		const FExpansion BD = CrossTerm(BEX, DEY, DEX, BEY);
+
+		const FExpansion ABC = Add(Add(Multiply(AEZ, BC), Negate(Multiply(BEZ, AC))), Multiply(CEZ, AB));
+		const FExpansion BCD = Add(Add(Multiply(BEZ, CD), Negate(Multiply(CEZ, BD))), Multiply(DEZ, BC));
+		const FExpansion CDA = Add(Add(Multiply(CEZ, DA), Multiply(DEZ, AC)), Multiply(AEZ, CD));
+		const FExpansion DAB = Add(Add(Multiply(DEZ, AB), Multiply(AEZ, BD)), Multiply(BEZ, DA));
+
+		auto Lift = [](const FExpansion& X, const FExpansion& Y, const FExpansion& Z)
+		{
+			return Add(Add(Multiply(X, X), Multiply(Y, Y)), Multiply(Z, Z));
+		};
+		const FExpansion Det = Add(
+			Add(Multiply(Lift(DEX, DEY, DEZ), ABC), Negate(Multiply(Lift(CEX, CEY, CEZ), DAB))),
+			Add(Multiply(Lift(BEX, BEY, BEZ), CDA), Negate(Multiply(Lift(AEX, AEY, AEZ), BCD))));
+		return -Estimate(Det);
+	}
+}
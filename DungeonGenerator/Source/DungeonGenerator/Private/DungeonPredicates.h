@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Robust geometric predicates for the triangulator. Each one is evaluated in doubles first and only when the result
+ * is within the rounding error bound it is recomputed exactly with floating point expansions, so the sign is always right.
+ */
+namespace DungeonPredicates
+{
+	//Half an ulp of 1.0
+	constexpr double Epsilon = 1.1102230246251565e-16;
+	//Error bounds of the double evaluation, from Shewchuk's "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates"
+	constexpr double OrientErrorBound = (7.0 + 56.0 * Epsilon) * Epsilon;
+	constexpr double InSphereErrorBound = (16.0 + 224.0 * Epsilon) * Epsilon;
+
+	/** Exact evaluations, only reached when the double result is within its error bound. */
+	DUNGEONGENERATOR_API double OrientExact(const FVector& A, const FVector& B, const FVector& C, const FVector& D);
+	DUNGEONGENERATOR_API double InSphereExact(const FVector& A, const FVector& B, const FVector& C, const FVector& D, const FVector& E);
+
+	/** Positive when D is on the side the normal of ABC points to (counter clockwise seen from D), zero if coplanar. */
+	FORCEINLINE double Orient(const FVector& A, const FVector& B, const FVector& C, const FVector& D)
+	{
+		const double ADX = A.X - D.X, ADY = A.Y - D.Y, ADZ = A.Z - D.Z;
+		const double BDX = B.X - D.X, BDY = B.Y - D.Y, BDZ = B.Z - D.Z;
+		const double CDX = C.X - D.X, CDY = C.Y - D.Y, CDZ = C.Z - D.Z;
+
+		const double BDXCDY = BDX * CDY, CDXBDY = CDX * BDY;
+		const double CDXADY = CDX * ADY, ADXCDY = ADX * CDY;
+		const double ADXBDY = ADX * BDY, BDXADY = BDX * ADY;
+
+		//Determinant of the rows A-D, B-D, C-D. It is positive for the opposite orientation, hence the negation
+		const double Det = ADZ * (BDXCDY - CDXBDY) + BDZ * (CDXADY - ADXCDY) + CDZ * (ADXBDY - BDXADY);
+		const double Permanent = (FMath::Abs(BDXCDY) + FMath::Abs(CDXBDY)) * FMath::Abs(ADZ)
+			+ (FMath::Abs(CDXADY) + FMath::Abs(ADXCDY)) * FMath::Abs(BDZ)
+			+ (FMath::Abs(ADXBDY) + FMath::Abs(BDXADY)) * FMath::Abs(CDZ);
+		const double ErrorBound = OrientErrorBound * Permanent;
+		if(Det > ErrorBound || -Det > ErrorBound)
+		{
+			return -Det;
+		}
+		return OrientExact(A, B, C, D);
+	}
+
+	/** For a positively oriented ABCD: positive when E is inside its circumsphere, zero if on it. */
+	FORCEINLINE double InSphere(const FVector& A, const FVector& B, const FVector& C, const FVector& D, const FVector& E)
+	{
+		const double AEX = A.X - E.X, AEY = A.Y - E.Y, AEZ = A.Z - E.Z;
+		const double BEX = B.X - E.X, BEY = B.Y - E.Y, BEZ = B.Z - E.Z;
+		const double CEX = C.X - E.X, CEY = C.Y - E.Y, CEZ = C.Z - E.Z;
+		const double DEX = D.X - E.X, DEY = D.Y - E.Y, DEZ = D.Z - E.Z;
+
+		const double AEXBEY = AEX * BEY, BEXAEY = BEX * AEY;
+		const double BEXCEY = BEX * CEY, CEXBEY = CEX * BEY;
+		const double CEXDEY = CEX * DEY, DEXCEY = DEX * CEY;
+		const double DEXAEY = DEX * AEY, AEXDEY = AEX * DEY;
+		const double AEXCEY = AEX * CEY, CEXAEY = CEX * AEY;
+		const double BEXDEY = BEX * DEY, DEXBEY = DEX * BEY;
+
+		const double AB = AEXBEY - BEXAEY;
+		const double BC = BEXCEY - CEXBEY;
+		const double CD = CEXDEY - DEXCEY;
+		const double DA = DEXAEY - AEXDEY;
+		const double AC = AEXCEY - CEXAEY;
+		const double BD = BEXDEY - DEXBEY;
+
+		const double ABC = AEZ * BC - BEZ * AC + CEZ * AB;
+		const double BCD = BEZ * CD - CEZ * BD + DEZ * BC;
+		const double CDA = CEZ * DA + DEZ * AC + AEZ * CD;
+		const double DAB = DEZ * AB + AEZ * BD + BEZ * DA;
+
+		const double ALift = AEX * AEX + AEY * AEY + AEZ * AEZ;
+		const double BLift = BEX * BEX + BEY * BEY + BEZ * BEZ;
+		const double CLift = CEX * CEX + CEY * CEY + CEZ * CEZ;
+		const double DLift = DEX * DEX + DEY * DEY + DEZ * DEZ;
+
+		//Same sign flip as Orient, the lifted determinant is positive inside for the opposite orientation
+		const double Det = (DLift * ABC - CLift * DAB) + (BLift * CDA - ALift * BCD);
+
+		const double AEZPlus = FMath::Abs(AEZ), BEZPlus = FMath::Abs(BEZ), CEZPlus = FMath::Abs(CEZ), DEZPlus = FMath::Abs(DEZ);
+		const double AEXBEYPlus = FMath::Abs(AEXBEY), BEXAEYPlus = FMath::Abs(BEXAEY);
+		const double BEXCEYPlus = FMath::Abs(BEXCEY), CEXBEYPlus = FMath::Abs(CEXBEY);
+		const double CEXDEYPlus = FMath::Abs(CEXDEY), DEXCEYPlus = FMath::Abs(DEXCEY);
+		const double DEXAEYPlus = FMath::Abs(DEXAEY), AEXDEYPlus = FMath::Abs(AEXDEY);
+		const double AEXCEYPlus = FMath::Abs(AEXCEY), CEXAEYPlus = FMath::Abs(CEXAEY);
+		const double BEXDEYPlus = FMath::Abs(BEXDEY), DEXBEYPlus = FMath::Abs(DEXBEY);
+		const double Permanent = ((CEXDEYPlus + DEXCEYPlus) * BEZPlus + (DEXBEYPlus + BEXDEYPlus) * CEZPlus + (BEXCEYPlus + CEXBEYPlus) * DEZPlus) * ALift
+			+ ((DEXAEYPlus + AEXDEYPlus) * CEZPlus + (AEXCEYPlus + CEXAEYPlus) * DEZPlus + (CEXDEYPlus + DEXCEYPlus) * AEZPlus) * BLift
+			+ ((AEXBEYPlus + BEXAEYPlus) * DEZPlus + (BEXDEYPlus + DEXBEYPlus) * AEZPlus + (DEXAEYPlus + AEXDEYPlus) * BEZPlus) * CLift
+			+ ((BEXCEYPlus + CEXBEYPlus) * AEZPlus + (CEXAEYPlus + AEXCEYPlus) * BEZPlus + (AEXBEYPlus + BEXAEYPlus) * CEZPlus) * DLift;
+		const double ErrorBound = InSphereErrorBound * Permanent;
+		if(Det > ErrorBound || -Det > ErrorBound)
+		{
+			return -Det;
+		}
+		return InSphereExact(A, B, C, D, E);
+	}
+}
@@ -3,6 +3,7 @@
 
 #include "DungeonRoom.h"
 
+#include "DungeonGeneratorStats.h"
 #include "DungeonMapperData.h"
 #include "UDynamicMesh.h"
 #include "Components/DynamicMeshComponent.h"
@@ -26,12 +27,13 @@ ADungeonRoom::ADungeonRoom()
 	RootComponent = DynamicMeshComponent;
 }
 
-void ADungeonRoom::InitializeRoom(const UDungeonRoomData* Node)
+void ADungeonRoom::InitializeRoom(const FDungeonNode& Node, const UDungeonRoomData* RoomData)
 {
+	SCOPE_DUNGEON_STAT(STAT_InitializeRoom);
 	UDynamicMesh* MainDynMesh = DynamicMeshComponent->GetDynamicMesh();
 	MainDynMesh->Reset();
 	TArray<UMaterialInterface*> MaterialList;
-	MaterialList.Add(Node->WallMaterial);
+	MaterialList.Add(RoomData->WallMaterial);
 	
 	FGeometryScriptPrimitiveOptions PrimitiveOptions;
 	MainDynMesh = UGeometryScriptLibrary_MeshPrimitiveFunctions::AppendBox
@@ -39,15 +41,15 @@ void ADungeonRoom::InitializeRoom(const UDungeonRoomData* Node)
 	MainDynMesh
 		, PrimitiveOptions
 		, FTransform::Identity
-		, Node->Extent.X*2.0f
-		, Node->Extent.Y*2.0f
-		,  Node->Extent.Z*2.0f
-		, Node->Extent.X*2.0f/125 + 1, Node->Extent.Y*2.0f/125 + 1, Node->Extent.Z*2.0f/125 + 1
+		, Node.Extent.X*2.0f
+		, Node.Extent.Y*2.0f
+		,  Node.Extent.Z*2.0f
+		, Node.Extent.X*2.0f/125 + 1, Node.Extent.Y*2.0f/125 + 1, Node.Extent.Z*2.0f/125 + 1
 		, EGeometryScriptPrimitiveOriginMode::Center
 	);
 	
-	const FTransform FloorLocation(FVector::ZeroVector - FVector(0,0,Node->Extent.Z - Node->WallThickness * 0.5f));
-	FKBoxElem FloorShape(Node->Extent.X, Node->Extent.Y, Node->WallThickness);
+	const FTransform FloorLocation(FVector::ZeroVector - FVector(0,0,Node.Extent.Z - RoomData->WallThickness * 0.5f));
+	FKBoxElem FloorShape(Node.Extent.X, Node.Extent.Y, RoomData->WallThickness);
 	FloorShape.SetTransform(FloorLocation);
 	DungeonCollision.AggGeom.BoxElems.Add(FloorShape);
 
@@ -62,15 +64,16 @@ void ADungeonRoom::InitializeRoom(const UDungeonRoomData* Node)
 	(
 		ToolMesh
 		, PrimitiveOptions
-		, FTransform::Identity*FTransform(FVector::UpVector*Node->WallThickness)
-		, Node->Extent.X*2.0f - Node->WallThickness * 2.0f
-		, Node->Extent.Y*2.0f - Node->WallThickness * 2.0f
-		,  Node->Extent.Z*2.0f
-		, Node->Extent.X*2.0f/125 + 1, Node->Extent.Y*2.0f/125 + 1, Node->Extent.Z*2.0f/125 + 1
+		, FTransform::Identity*FTransform(FVector::UpVector*RoomData->WallThickness)
+		, Node.Extent.X*2.0f - RoomData->WallThickness * 2.0f
+		, Node.Extent.Y*2.0f - RoomData->WallThickness * 2.0f
+		,  Node.Extent.Z*2.0f
+		, Node.Extent.X*2.0f/125 + 1, Node.Extent.Y*2.0f/125 + 1, Node.Extent.Z*2.0f/125 + 1
 		, EGeometryScriptPrimitiveOriginMode::Center
 	);
 	
 	FGeometryScriptMeshBooleanOptions BoolOptions;
+	INC_DWORD_STAT(STAT_BooleanOperations);
 	MainDynMesh = UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 	(
 		MainDynMesh,
@@ -81,13 +84,14 @@ void ADungeonRoom::InitializeRoom(const UDungeonRoomData* Node)
 		BoolOptions		
 	);
 	ReleaseComputeMesh(ToolMesh);
-	CreateDoors(MainDynMesh, Node, MaterialList);
+	CreateDoors(MainDynMesh, Node, RoomData, MaterialList);
 	DynamicMeshComponent->ConfigureMaterialSet(MaterialList);
 }
 
-void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* DungeonsNode, TArray<UMaterialInterface*>& OutMaterialList)
+void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const FDungeonNode& DungeonsNode, const UDungeonRoomData* RoomData, TArray<UMaterialInterface*>& OutMaterialList)
 {
-	for (const FTransform OriginalDoorTransform : DungeonsNode->Doors)
+	SCOPE_DUNGEON_STAT(STAT_CreateDoors);
+	for (const FTransform OriginalDoorTransform : DungeonsNode.Doors)
 	{
 		FTransform DoorTransform = OriginalDoorTransform.GetRelativeTransform(GetActorTransform());
 		if(DoorTransform.GetUnitAxis(EAxis::X).GetAbs().Equals(FVector::UpVector))
@@ -96,7 +100,7 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 		}
 
 		UDynamicMesh* ToolMesh = AllocateComputeMesh();
-		UStaticMesh* DoorMesh = DungeonsNode->DoorMesh;
+		UStaticMesh* DoorMesh = RoomData->DoorMesh;
 
 		FGeometryScriptCopyMeshFromAssetOptions AssetOptions;
 		FGeometryScriptMeshReadLOD RequestedLOD;
@@ -115,7 +119,7 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 
 		//Scale door to fit wall
 		float DoorHeight = DoorBounds.GetExtent().Z * 2.0f;
-		float RoomWallHeight = DungeonsNode->Extent.Z * 2.0f - DungeonsNode->WallThickness * 2.0f;
+		float RoomWallHeight = DungeonsNode.Extent.Z * 2.0f - RoomData->WallThickness * 2.0f;
 		float ScaleRate = DoorHeight > RoomWallHeight ? RoomWallHeight / DoorHeight : 1.0f;
 		ToolMesh = UGeometryScriptLibrary_MeshTransformFunctions::ScaleMesh(ToolMesh, FVector(ScaleRate));
 
@@ -123,7 +127,7 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 		FVector DoorForward = DoorTransform.GetUnitAxis(EAxis::X);
 		if(DoorForward.Equals(FVector::ForwardVector)  || DoorForward.Equals(FVector::BackwardVector) || DoorForward.Equals(FVector::RightVector) || DoorForward.Equals(FVector::LeftVector))
 		{
-			FVector Translation(-DungeonsNode->WallThickness*0.5f, 0.0f, -RoomWallHeight * 0.5);
+			FVector Translation(-RoomData->WallThickness*0.5f, 0.0f, -RoomWallHeight * 0.5);
 			Translation = DoorTransform.TransformVector(Translation);
 			DoorTransform.AddToTranslation(Translation);
 		}
@@ -137,7 +141,7 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 						BooleanMesh
 						, PrimitiveOptions
 						, DoorTransform
-						, (DoorBounds.GetExtent().X + DungeonsNode->WallThickness) * 2.0f
+						, (DoorBounds.GetExtent().X + RoomData->WallThickness) * 2.0f
 						, DoorBounds.GetExtent().Y * 2.0f
 						,  DoorBounds.GetExtent().Z * 2.0f
 						, 0, 0, 0
@@ -145,6 +149,7 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 					);
 		
 		FGeometryScriptMeshBooleanOptions BoolOptions;
+		INC_DWORD_STAT(STAT_BooleanOperations);
 		DynMesh = UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 				(
 					DynMesh,
@@ -170,6 +175,7 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 			}
 		}
 		ToolMesh = UGeometryScriptLibrary_MeshMaterialFunctions::RemapToNewMaterialIDsByMaterial(ToolMesh, OldMaterialList, OutMaterialList);
+		INC_DWORD_STAT(STAT_BooleanOperations);
 		DynMesh = UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 				(
 					DynMesh,
@@ -183,6 +189,11 @@ void ADungeonRoom::CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* D
 	}
 }
 
+int32 ADungeonRoom::GetTriangleCount() const
+{
+	return DynamicMeshComponent->GetDynamicMesh()->GetTriangleCount();
+}
+
 UDynamicMeshPool* ADungeonRoom::GetComputeMeshPool()
 {
 	if (DynamicMeshPool == nullptr)
@@ -11,7 +11,6 @@
 class UDynamicMesh;
 class UDynamicMeshPool;
 class UDynamicMeshComponent;
-struct FDungeonNode;
 
 UCLASS()
 class ADungeonRoom : public AActor
@@ -21,8 +20,9 @@ class ADungeonRoom : public AActor
 public:	
 	// Sets default values for this actor's properties
 	ADungeonRoom();
-	void InitializeRoom(const UDungeonRoomData* Node);
-	void CreateDoors(UDynamicMesh*& DynMesh, const UDungeonRoomData* DungeonsNode, TArray<UMaterialInterface*>& OutMaterialList);
+	void InitializeRoom(const FDungeonNode& Node, const UDungeonRoomData* RoomData);
+	void CreateDoors(UDynamicMesh*& DynMesh, const FDungeonNode& DungeonsNode, const UDungeonRoomData* RoomData, TArray<UMaterialInterface*>& OutMaterialList);
+	int32 GetTriangleCount() const;
 
 private:
 	/** Access the compute mesh pool */
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonRoomBVH.h"
+
+#include "DungeonMapperData.h"
+
+void FDungeonRoomBVH::Build(TConstArrayView<FDungeonNode> Rooms)
+{
+	Reset();
+	if(Rooms.IsEmpty())
+	{
+		return;
+	}
+
+	RoomIndices.SetNumUninitialized(Rooms.Num());
+	for (int32 RoomIdx = 0; RoomIdx < Rooms.Num(); ++RoomIdx)
+	{
+		RoomIndices[RoomIdx] = RoomIdx;
+	}
+	Nodes.Reserve(2 * FMath::DivideAndRoundUp(Rooms.Num(), MaxLeafRooms));
+	Nodes.AddDefaulted();
+	BuildNode(Rooms, 0, 0, Rooms.Num());
+}
+
+void FDungeonRoomBVH::BuildNode(TConstArrayView<FDungeonNode> Rooms, int32 NodeIdx, int32 FirstRoom, int32 NumRooms)
+{
+	FBox CenterBounds(ForceInit);
+	for (int32 Idx = FirstRoom; Idx < FirstRoom + NumRooms; ++Idx)
+	{
+		const FDungeonNode& Room = Rooms[RoomIndices[Idx]];
+		Nodes[NodeIdx].Bounds += Room.GetBounds();
+		CenterBounds += Room.Location;
+	}
+	if(NumRooms <= MaxLeafRooms)
+	{
+		Nodes[NodeIdx].First = FirstRoom;
+		Nodes[NodeIdx].NumRooms = NumRooms;
+		return;
+	}
+
+	//Split at the middle of the longest axis of the room centers, or in half if every center ends on one side
+	const FVector CenterSize = CenterBounds.GetSize();
+	const int32 SplitAxis = CenterSize.X >= CenterSize.Y && CenterSize.X >= CenterSize.Z ? 0 : (CenterSize.Y >= CenterSize.Z ? 1 : 2);
+	const double SplitCoord = CenterBounds.GetCenter()[SplitAxis];
+	int32 NumLeft = 0;
+	for (int32 Idx = FirstRoom; Idx < FirstRoom + NumRooms; ++Idx)
+	{
+		if(Rooms[RoomIndices[Idx]].Location[SplitAxis] < SplitCoord)
+		{
+			Swap(RoomIndices[Idx], RoomIndices[FirstRoom + NumLeft]);
+			++NumLeft;
+		}
+	}
+	if(NumLeft == 0 || NumLeft == NumRooms)
+	{
+		NumLeft = NumRooms / 2;
+	}
+
+	const int32 FirstChild = Nodes.Num();
+	Nodes.AddDefaulted(2);
+	Nodes[NodeIdx].First = FirstChild;
+	BuildNode(Rooms, FirstChild, FirstRoom, NumLeft);
+	BuildNode(Rooms, FirstChild + 1, FirstRoom + NumLeft, NumRooms - NumLeft);
+}
+
+void FDungeonRoomBVH::Refit(TConstArrayView<FDungeonNode> Rooms)
+{
+	//Children always come after their parent, so going backwards every child is refit before its parent
+	for (int32 NodeIdx = Nodes.Num() - 1; NodeIdx >= 0; --NodeIdx)
+	{
+		FNode& Node = Nodes[NodeIdx];
+		Node.Bounds = FBox(ForceInit);
+		if(Node.NumRooms > 0)
+		{
+			for (int32 Idx = Node.First; Idx < Node.First + Node.NumRooms; ++Idx)
+			{
+				Node.Bounds += Rooms[RoomIndices[Idx]].GetBounds();
+			}
+		}
+		else
+		{
+			Node.Bounds = Nodes[Node.First].Bounds + Nodes[Node.First + 1].Bounds;
+		}
+	}
+}
+
+void FDungeonRoomBVH::Reset()
+{
+	Nodes.Reset();
+	RoomIndices.Reset();
+}
+
+void FDungeonRoomBVH::QuerySegment(const FVector& Start, const FVector& End, const FVector& Extent, TArray<int32>& OutRooms) const
+{
+	OutRooms.Reset();
+	if(Nodes.IsEmpty())
+	{
+		return;
+	}
+
+	const FVector Direction = End - Start;
+	const FVector Expansion = Extent + FVector(QueryTolerance);
+	TArray<int32, TInlineAllocator<64>> NodeStack;
+	NodeStack.Add(0);
+	while (!NodeStack.IsEmpty())
+	{
+		const FNode& Node = Nodes[NodeStack.Pop(EAllowShrinking::No)];
+		if(!SegmentOverlaps(Node.Bounds.ExpandBy(Expansion), Start, Direction))
+		{
+			continue;
+		}
+		if(Node.NumRooms > 0)
+		{
+			OutRooms.Append(&RoomIndices[Node.First], Node.NumRooms);
+		}
+		else
+		{
+			NodeStack.Add(Node.First);
+			NodeStack.Add(Node.First + 1);
+		}
+	}
+	//Leaves can overlap the segment while their rooms don't, the callers test the rooms themselves
+	OutRooms.Sort();
+}
+
+void FDungeonRoomBVH::QueryPoint(const FVector& Point, TArray<int32>& OutRooms) const
+{
+	OutRooms.Reset();
+	if(Nodes.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> NodeStack;
+	NodeStack.Add(0);
+	while (!NodeStack.IsEmpty())
+	{
+		const FNode& Node = Nodes[NodeStack.Pop(EAllowShrinking::No)];
+		if(!Node.Bounds.IsInsideOrOn(Point))
+		{
+			continue;
+		}
+		if(Node.NumRooms > 0)
+		{
+			OutRooms.Append(&RoomIndices[Node.First], Node.NumRooms);
+		}
+		else
+		{
+			NodeStack.Add(Node.First);
+			NodeStack.Add(Node.First + 1);
+		}
+	}
+	OutRooms.Sort();
+}
+
+bool FDungeonRoomBVH::SegmentOverlaps(const FBox& Box, const FVector& Start, const FVector& Direction)
+{
+	//Slab test over the segment parameter range
+	double MinTime = 0.0;
+	double MaxTime = 1.0;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if(Direction[Axis] == 0.0)
+		{
+			if(Start[Axis] < Box.Min[Axis] || Start[Axis] > Box.Max[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
+		const double OneOverDirection = 1.0 / Direction[Axis];
+		double EnterTime = (Box.Min[Axis] - Start[Axis]) * OneOverDirection;
+		double ExitTime = (Box.Max[Axis] - Start[Axis]) * OneOverDirection;
+		if(EnterTime > ExitTime)
+		{
+			Swap(EnterTime, ExitTime);
+		}
+		MinTime = FMath::Max(MinTime, EnterTime);
+		MaxTime = FMath::Min(MaxTime, ExitTime);
+		if(MinTime > MaxTime)
+		{
+			return false;
+		}
+	}
+	return true;
+}
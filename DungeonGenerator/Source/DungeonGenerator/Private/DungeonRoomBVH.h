@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDungeonNode;
+
+/**
+ * Bounding volume hierarchy over the room bounds of a layout. Built once when the rooms are placed and refit when
+ * they move, the tree shape is kept so refitting is linear. Queries return the candidate rooms whose bounds overlap,
+ * the callers still run their exact test on them.
+ */
+class DUNGEONGENERATOR_API FDungeonRoomBVH
+{
+public:
+	//Rooms per leaf
+	static constexpr int32 MaxLeafRooms = 4;
+	//Slack added to the node bounds on queries, so a touching room is never missed because of rounding
+	static constexpr double QueryTolerance = 0.1;
+
+	void Build(TConstArrayView<FDungeonNode> Rooms);
+	/** Updates the bounds after the rooms moved. The rooms must be the same ones the tree was built with. */
+	void Refit(TConstArrayView<FDungeonNode> Rooms);
+	void Reset();
+	bool IsEmpty() const { return Nodes.IsEmpty(); }
+
+	/** Rooms whose bounds grown by Extent the segment from Start to End overlaps, sorted by index. A zero extent tests
+	 * the segment itself, a hallway section half size sweeps a box along it. */
+	void QuerySegment(const FVector& Start, const FVector& End, const FVector& Extent, TArray<int32>& OutRooms) const;
+	/** Rooms whose bounds contain the point, sorted by index. */
+	void QueryPoint(const FVector& Point, TArray<int32>& OutRooms) const;
+
+private:
+	struct FNode
+	{
+		FBox Bounds = FBox(ForceInit);
+		//Leaves: first entry in RoomIndices. Inner nodes: first child, the second one comes right after it
+		int32 First = 0;
+		//Rooms in a leaf, 0 for inner nodes
+		int32 NumRooms = 0;
+	};
+
+	void BuildNode(TConstArrayView<FDungeonNode> Rooms, int32 NodeIdx, int32 FirstRoom, int32 NumRooms);
+	static bool SegmentOverlaps(const FBox& Box, const FVector& Start, const FVector& Direction);
+
+	TArray<FNode> Nodes;
+	TArray<int32> RoomIndices;
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonSeedSearch.h"
+
+#include "Async/ParallelFor.h"
+
+TArray<FDungeonSeedResult> FDungeonSeedSearch::FindSeeds(const FDungeonLayoutSettings& BaseSettings, TConstArrayView<int32> Seeds, const FDungeonSeedConstraints& Constraints)
+{
+	//One slot per seed so workers never share state, compacted afterwards
+	TArray<FDungeonSeedResult> SeedResults;
+	SeedResults.SetNum(Seeds.Num());
+	TArray<bool> ValidSeeds;
+	ValidSeeds.Init(false, Seeds.Num());
+
+	ParallelFor(Seeds.Num(), [&](int32 SeedIdx)
+	{
+		FDungeonLayout Layout(BaseSettings);
+		Layout.Settings.RandomSeed = Seeds[SeedIdx];
+		ValidSeeds[SeedIdx] = EvaluateSeed(Layout, Constraints, SeedResults[SeedIdx]);
+		SeedResults[SeedIdx].SeedIndex = SeedIdx;
+	}, EParallelForFlags::Unbalanced);
+
+	TArray<FDungeonSeedResult> AcceptedSeeds;
+	for (int32 SeedIdx = 0; SeedIdx < Seeds.Num(); ++SeedIdx)
+	{
+		if(ValidSeeds[SeedIdx])
+		{
+			AcceptedSeeds.Add(SeedResults[SeedIdx]);
+		}
+	}
+
+	AcceptedSeeds.Sort([](const FDungeonSeedResult& A, const FDungeonSeedResult& B)
+	{
+		if(A.CriticalPathLength != B.CriticalPathLength)
+		{
+			return A.CriticalPathLength > B.CriticalPathLength;
+		}
+		return A.SeedIndex < B.SeedIndex;
+	});
+	return AcceptedSeeds;
+}
+
+bool FDungeonSeedSearch::EvaluateSeed(FDungeonLayout& Layout, const FDungeonSeedConstraints& Constraints, FDungeonSeedResult& OutResult)
+{
+	OutResult.RandomSeed = Layout.Settings.RandomSeed;
+
+	//Room count is settled as soon as the rooms are spawned
+	Layout.GenerateRooms();
+	OutResult.RoomCount = Layout.DungeonNodes.Num();
+	if(OutResult.RoomCount < Constraints.MinRoomCount || (Constraints.MaxRoomCount > 0 && OutResult.RoomCount > Constraints.MaxRoomCount))
+	{
+		return false;
+	}
+	if(Constraints.MinCriticalPathRooms > OutResult.RoomCount)
+	{
+		return false;
+	}
+
+	//Simplification only removes connections, so if the full graph is already short of branches so will the simplified one
+	Layout.ConnectRooms();
+	if(CountBranchRooms(Layout) < Constraints.MinBranchRooms)
+	{
+		return false;
+	}
+
+	Layout.Collapse();
+	Layout.SimplifyConnections();
+	OutResult.CriticalPathLength = Layout.CriticalPathLength;
+	OutResult.CriticalPathRooms = Layout.CriticalPathRoomCount;
+	OutResult.BranchRooms = CountBranchRooms(Layout);
+
+	if(OutResult.CriticalPathLength < Constraints.MinCriticalPathLength || OutResult.CriticalPathRooms < Constraints.MinCriticalPathRooms)
+	{
+		return false;
+	}
+	if(OutResult.BranchRooms < Constraints.MinBranchRooms || (Constraints.MaxBranchRooms > 0 && OutResult.BranchRooms > Constraints.MaxBranchRooms))
+	{
+		return false;
+	}
+	return true;
+}
+
+int32 FDungeonSeedSearch::CountBranchRooms(const FDungeonLayout& Layout)
+{
+	int32 BranchRooms = 0;
+	for (int32 RoomIdx = 0; RoomIdx < Layout.RoomGraph.GetNumRooms(); ++RoomIdx)
+	{
+		if(Layout.RoomGraph.GetDegree(RoomIdx) >= 3)
+		{
+			++BranchRooms;
+		}
+	}
+	return BranchRooms;
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonLayout.h"
+#include "DungeonSeedSearch.generated.h"
+
+/** Requirements a layout has to meet for its seed to be accepted. Zero means unbounded. */
+USTRUCT(BlueprintType)
+struct FDungeonSeedConstraints
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), category = "Dungeon Mapper|Seed Search")
+	int32 MinRoomCount = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), category = "Dungeon Mapper|Seed Search")
+	int32 MaxRoomCount = 0;
+	//Distance between room centers along the path from the Starting room to the End room
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), category = "Dungeon Mapper|Seed Search")
+	float MinCriticalPathLength = 0.0f;
+	//Rooms along the path from the Starting room to the End room, both included
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), category = "Dungeon Mapper|Seed Search")
+	int32 MinCriticalPathRooms = 0;
+	//Rooms with three or more connections once the connections are simplified
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), category = "Dungeon Mapper|Seed Search")
+	int32 MinBranchRooms = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), category = "Dungeon Mapper|Seed Search")
+	int32 MaxBranchRooms = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FDungeonSeedResult
+{
+	GENERATED_BODY()
+
+	//Index of the seed in the candidate list
+	UPROPERTY(BlueprintReadOnly, category = "Dungeon Mapper|Seed Search")
+	int32 SeedIndex = INDEX_NONE;
+	UPROPERTY(BlueprintReadOnly, category = "Dungeon Mapper|Seed Search")
+	int32 RandomSeed = 0;
+	UPROPERTY(BlueprintReadOnly, category = "Dungeon Mapper|Seed Search")
+	int32 RoomCount = 0;
+	UPROPERTY(BlueprintReadOnly, category = "Dungeon Mapper|Seed Search")
+	float CriticalPathLength = 0.0f;
+	UPROPERTY(BlueprintReadOnly, category = "Dungeon Mapper|Seed Search")
+	int32 CriticalPathRooms = 0;
+	UPROPERTY(BlueprintReadOnly, category = "Dungeon Mapper|Seed Search")
+	int32 BranchRooms = 0;
+};
+
+/**
+ * Evaluates many seeds in parallel running only the layout stages (rooms, connections, collapse and simplification).
+ * Each seed is dropped at the first stage that already breaks a constraint.
+ */
+class DUNGEONGENERATOR_API FDungeonSeedSearch
+{
+public:
+	/** Returns the seeds meeting the constraints, longest critical path first. */
+	static TArray<FDungeonSeedResult> FindSeeds(const FDungeonLayoutSettings& BaseSettings, TConstArrayView<int32> Seeds, const FDungeonSeedConstraints& Constraints);
+	/** Runs the layout stages for Layout.Settings.RandomSeed. Returns false as soon as a constraint fails. */
+	static bool EvaluateSeed(FDungeonLayout& Layout, const FDungeonSeedConstraints& Constraints, FDungeonSeedResult& OutResult);
+
+private:
+	static int32 CountBranchRooms(const FDungeonLayout& Layout);
+};
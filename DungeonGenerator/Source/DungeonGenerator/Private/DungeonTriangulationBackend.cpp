@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonTriangulationBackend.h"
+
+#include "CompGeom/Delaunay3.h"
+#include "DungeonGeneratorStats.h"
+#include "DungeonParallelTriangulator.h"
+#include "DungeonTriangulator.h"
+
+TUniquePtr<ITriangulationBackend> ITriangulationBackend::Create(ETriangulationBackend Backend, int32 NumPoints, int32 ParallelMinPoints)
+{
+	if(Backend == ETriangulationBackend::Auto)
+	{
+		Backend = ParallelMinPoints > 0 && NumPoints >= ParallelMinPoints ? ETriangulationBackend::ParallelBowyerWatson : ETriangulationBackend::BowyerWatson;
+	}
+
+	switch (Backend)
+	{
+	case ETriangulationBackend::ParallelBowyerWatson:
+		return MakeUnique<FParallelBowyerWatsonTriangulationBackend>();
+	case ETriangulationBackend::GeometryCore:
+		return MakeUnique<FGeometryCoreTriangulationBackend>();
+	default:
+		return MakeUnique<FBowyerWatsonTriangulationBackend>();
+	}
+}
+
+int32 FBowyerWatsonTriangulationBackend::Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges)
+{
+	FDungeonTriangulator Triangulator;
+	Triangulator.Triangulate(Points);
+	Triangulator.GetEdges(OutEdges);
+	return Triangulator.GetNumTetrahedra();
+}
+
+int32 FParallelBowyerWatsonTriangulationBackend::Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges)
+{
+	FDungeonParallelTriangulator Triangulator;
+	Triangulator.Triangulate(Points);
+	Triangulator.GetEdges(OutEdges);
+	return Triangulator.GetNumTetrahedra();
+}
+
+int32 FGeometryCoreTriangulationBackend::Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges)
+{
+	static constexpr int32 TetraEdges[6][2] = {{0, 1}, {1, 2}, {2, 0}, {3, 0}, {3, 1}, {3, 2}};
+	OutEdges.Reset();
+
+	UE::Geometry::FDelaunay3 Delaunay;
+	if(!Delaunay.Triangulate(TArrayView<const FVector3d>(Points.GetData(), Points.Num())))
+	{
+		//Fewer than four points or all of them coplanar. The super tetrahedron of Bowyer-Watson still connects those
+		UE_LOG(LogDungeonGenerator, Warning, TEXT("GeometryCore couldn't triangulate %d rooms, falling back to BowyerWatson"), Points.Num());
+		return FBowyerWatsonTriangulationBackend().Triangulate(Points, OutEdges);
+	}
+
+	const TArray<FIntVector4> Tetrahedra = Delaunay.GetTetrahedra();
+	OutEdges.Reserve(Tetrahedra.Num() * 6);
+	for (const FIntVector4& Tetra : Tetrahedra)
+	{
+		for (const int32 (&Edge)[2] : TetraEdges)
+		{
+			OutEdges.Add(FDungeonTriangulator::MakeEdge(Tetra[Edge[0]], Tetra[Edge[1]]));
+		}
+	}
+	FDungeonTriangulator::SortUniqueEdges(OutEdges);
+	return Tetrahedra.Num();
+}
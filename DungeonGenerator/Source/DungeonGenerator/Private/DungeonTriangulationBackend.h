@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonMapperData.h"
+
+/**
+ * Delaunay triangulation of the room locations as used by FDungeonLayout::ConnectRooms. Implementations only have to
+ * produce the edges between the points, so they can be swapped without touching the connection code.
+ */
+class DUNGEONGENERATOR_API ITriangulationBackend
+{
+public:
+	virtual ~ITriangulationBackend() = default;
+
+	virtual const TCHAR* GetName() const = 0;
+	/** Writes the Delaunay edges between the points as FDungeonTriangulator::MakeEdge keys, sorted and unique. Returns
+	 * the number of tetrahedra the backend produced. */
+	virtual int32 Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges) = 0;
+
+	/** Backend for a method, Auto picks from ParallelMinPoints. Never null. */
+	static TUniquePtr<ITriangulationBackend> Create(ETriangulationBackend Backend, int32 NumPoints = 0, int32 ParallelMinPoints = 0);
+};
+
+class DUNGEONGENERATOR_API FBowyerWatsonTriangulationBackend : public ITriangulationBackend
+{
+public:
+	//Override - ITriangulationBackend - START
+	virtual const TCHAR* GetName() const override { return TEXT("BowyerWatson"); }
+	virtual int32 Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges) override;
+	//Override - ITriangulationBackend - END
+};
+
+class DUNGEONGENERATOR_API FParallelBowyerWatsonTriangulationBackend : public ITriangulationBackend
+{
+public:
+	//Override - ITriangulationBackend - START
+	virtual const TCHAR* GetName() const override { return TEXT("ParallelBowyerWatson"); }
+	virtual int32 Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges) override;
+	//Override - ITriangulationBackend - END
+};
+
+/** Adapter over UE::Geometry::FDelaunay3. Its tetrahedra only cover the convex hull of the points. */
+class DUNGEONGENERATOR_API FGeometryCoreTriangulationBackend : public ITriangulationBackend
+{
+public:
+	//Override - ITriangulationBackend - START
+	virtual const TCHAR* GetName() const override { return TEXT("GeometryCore"); }
+	virtual int32 Triangulate(TConstArrayView<FVector> Points, TArray<uint64>& OutEdges) override;
+	//Override - ITriangulationBackend - END
+};
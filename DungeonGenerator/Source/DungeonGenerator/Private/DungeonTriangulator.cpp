@@ -0,0 +1,479 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonTriangulator.h"
+
+#include "DungeonGeneratorStats.h"
+#include "DungeonPredicates.h"
+
+void FDungeonTriangulator::Triangulate(TConstArrayView<FVector> InPoints)
+{
+	FBox PointBounds(ForceInit);
+	for (const FVector& Point : InPoints)
+	{
+		PointBounds += Point;
+	}
+	Triangulate(InPoints, PointBounds);
+}
+
+void FDungeonTriangulator::Triangulate(TConstArrayView<FVector> InPoints, const FBox& SuperBounds)
+{
+	Reset();
+	if(InPoints.IsEmpty())
+	{
+		return;
+	}
+
+	NumPoints = InPoints.Num();
+	Points.Reserve(NumPoints + 4);
+	Points.Append(InPoints.GetData(), InPoints.Num());
+	//Every insertion adds around six tetrahedra more than it removes
+	Tetrahedra.Reserve(NumPoints * 7);
+	CavityMarks.Reserve(NumPoints * 7);
+	CircumSpheres.Reserve(NumPoints * 7);
+
+	CreateSuperTetrahedron(SuperBounds);
+	TArray<int32> InsertionOrder;
+	MakeInsertionOrder(InsertionOrder);
+	for (const int32 PointIdx : InsertionOrder)
+	{
+		if(!InsertPoint(PointIdx))
+		{
+			UE_LOG(LogDungeonGenerator, Warning, TEXT("Room at %s overlaps another room center and won't be connected"), *Points[PointIdx].ToString());
+		}
+	}
+}
+
+void FDungeonTriangulator::Reset()
+{
+	Points.Reset();
+	NumPoints = 0;
+	Tetrahedra.Reset();
+	CircumSpheres.Reset();
+	FreeTetrahedra.Reset();
+	CavityMarks.Reset();
+	CavityMark = 0;
+	LastTetrahedron = INDEX_NONE;
+	WalkRandomStream.Initialize(0);
+}
+
+void FDungeonTriangulator::GetEdges(TArray<uint64>& OutEdges) const
+{
+	static constexpr int32 TetraEdges[6][2] = {{0, 1}, {1, 2}, {2, 0}, {3, 0}, {3, 1}, {3, 2}};
+	OutEdges.Reset();
+	for (const FTetrahedron& Tetra : Tetrahedra)
+	{
+		if(Tetra.bIsDead)
+		{
+			continue;
+		}
+		for (const int32 (&Edge)[2] : TetraEdges)
+		{
+			if(!IsSuperVertex(Tetra.Verts[Edge[0]]) && !IsSuperVertex(Tetra.Verts[Edge[1]]))
+			{
+				OutEdges.Add(MakeEdge(Tetra.Verts[Edge[0]], Tetra.Verts[Edge[1]]));
+			}
+		}
+	}
+	SortUniqueEdges(OutEdges);
+}
+
+void FDungeonTriangulator::SortUniqueEdges(TArray<uint64>& InOutEdges)
+{
+	//Below this a comparison sort beats clearing the digit histograms
+	constexpr int32 MinRadixSortEdges = 1024;
+	constexpr int32 DigitBits = 16;
+	constexpr int32 NumDigits = 1 << DigitBits;
+	if(InOutEdges.Num() < MinRadixSortEdges)
+	{
+		InOutEdges.Sort();
+	}
+	else
+	{
+		//LSD radix sort, one pass per 16 bit digit. Digits every key shares are skipped, room indices rarely fill 32 bits
+		uint64 AnyBits = 0;
+		uint64 AllBits = MAX_uint64;
+		for (const uint64 Edge : InOutEdges)
+		{
+			AnyBits |= Edge;
+			AllBits &= Edge;
+		}
+		TArray<uint64> SortedEdges;
+		SortedEdges.SetNumUninitialized(InOutEdges.Num());
+		TArray<int32> DigitOffsets;
+		DigitOffsets.SetNumUninitialized(NumDigits);
+		for (int32 Shift = 0; Shift < 64; Shift += DigitBits)
+		{
+			if(((AnyBits ^ AllBits) >> Shift & (NumDigits - 1)) == 0)
+			{
+				continue;
+			}
+			FMemory::Memzero(DigitOffsets.GetData(), NumDigits * sizeof(int32));
+			for (const uint64 Edge : InOutEdges)
+			{
+				++DigitOffsets[Edge >> Shift & (NumDigits - 1)];
+			}
+			int32 Offset = 0;
+			for (int32& DigitOffset : DigitOffsets)
+			{
+				const int32 Count = DigitOffset;
+				DigitOffset = Offset;
+				Offset += Count;
+			}
+			for (const uint64 Edge : InOutEdges)
+			{
+				SortedEdges[DigitOffsets[Edge >> Shift & (NumDigits - 1)]++] = Edge;
+			}
+			Swap(InOutEdges, SortedEdges);
+		}
+	}
+	int32 NumUnique = 0;
+	for (int32 EdgeIdx = 0; EdgeIdx < InOutEdges.Num(); ++EdgeIdx)
+	{
+		if(NumUnique == 0 || InOutEdges[EdgeIdx] != InOutEdges[NumUnique - 1])
+		{
+			InOutEdges[NumUnique++] = InOutEdges[EdgeIdx];
+		}
+	}
+	InOutEdges.SetNum(NumUnique);
+}
+
+void FDungeonTriangulator::AppendSuperVertices(const FBox& SuperBounds, TArray<FVector>& OutPoints)
+{
+	//Generate a big enough tetra so that it engulf all vertex(rooms)
+	//Points sit at least Size away from the corner, and their coordinates relative to it add up to at most 6 Size
+	const double Size = FMath::Max(SuperBounds.GetSize().GetMax(), 1.0);
+	const FVector Corner = SuperBounds.Min - FVector(Size);
+	const double Legs = Size * 10.0;
+	OutPoints.Add(Corner);
+	OutPoints.Add(Corner + FVector(Legs, 0.0, 0.0));
+	OutPoints.Add(Corner + FVector(0.0, Legs, 0.0));
+	OutPoints.Add(Corner + FVector(0.0, 0.0, Legs));
+}
+
+void FDungeonTriangulator::CreateSuperTetrahedron(const FBox& SuperBounds)
+{
+	AppendSuperVertices(SuperBounds, Points);
+	const int32 SuperVerts[4] = {NumPoints, NumPoints + 1, NumPoints + 2, NumPoints + 3};
+	LastTetrahedron = AllocateTetrahedron(SuperVerts);
+}
+
+void FDungeonTriangulator::MakeInsertionOrder(TArray<int32>& OutOrder) const
+{
+	//Biased randomized insertion order: shuffled points are split in rounds, the last one holding half of them, the one
+	//before a quarter and so on. Every round is sorted along a Hilbert curve so consecutive points are close in space
+	//and the walk from the last tetrahedron stays short, while the rounds keep the expected cost of a random order
+	struct FInsertionKey
+	{
+		int32 Round;
+		uint64 HilbertIndex;
+		int32 PointIdx;
+	};
+
+	FBox PointBounds(Points[0], Points[0]);
+	for (int32 PointIdx = 1; PointIdx < NumPoints; ++PointIdx)
+	{
+		PointBounds += Points[PointIdx];
+	}
+	const double Scale = ((1 << HilbertBits) - 1) / FMath::Max(PointBounds.GetSize().GetMax(), UE_DOUBLE_SMALL_NUMBER);
+
+	TArray<FInsertionKey> Keys;
+	Keys.SetNumUninitialized(NumPoints);
+	for (int32 PointIdx = 0; PointIdx < NumPoints; ++PointIdx)
+	{
+		const FVector Cell = (Points[PointIdx] - PointBounds.Min) * Scale;
+		Keys[PointIdx].HilbertIndex = HilbertIndex(static_cast<uint32>(Cell.X), static_cast<uint32>(Cell.Y), static_cast<uint32>(Cell.Z));
+		Keys[PointIdx].PointIdx = PointIdx;
+	}
+
+	const FRandomStream ShuffleStream(NumPoints);
+	for (int32 KeyIdx = NumPoints - 1; KeyIdx > 0; --KeyIdx)
+	{
+		Keys.Swap(KeyIdx, ShuffleStream.RandRange(0, KeyIdx));
+	}
+	//Every key takes the end of its round as round id, so sorting by it puts the rounds in insertion order
+	int32 RoundEnd = NumPoints;
+	while (RoundEnd > BRIOMinRoundSize)
+	{
+		const int32 RoundStart = RoundEnd / 2;
+		for (int32 KeyIdx = RoundStart; KeyIdx < RoundEnd; ++KeyIdx)
+		{
+			Keys[KeyIdx].Round = RoundEnd;
+		}
+		RoundEnd = RoundStart;
+	}
+	for (int32 KeyIdx = 0; KeyIdx < RoundEnd; ++KeyIdx)
+	{
+		Keys[KeyIdx].Round = RoundEnd;
+	}
+	Keys.Sort([](const FInsertionKey& A, const FInsertionKey& B)
+	{
+		return A.Round != B.Round ? A.Round < B.Round : A.HilbertIndex < B.HilbertIndex;
+	});
+
+	OutOrder.Reset(NumPoints);
+	for (const FInsertionKey& Key : Keys)
+	{
+		OutOrder.Add(Key.PointIdx);
+	}
+}
+
+uint64 FDungeonTriangulator::HilbertIndex(uint32 X, uint32 Y, uint32 Z)
+{
+	//Skilling's transform from axes to the transposed Hilbert index, then the bits are interleaved
+	uint32 Axes[3] = {X, Y, Z};
+	for (uint32 Bit = 1u << (HilbertBits - 1); Bit > 1; Bit >>= 1)
+	{
+		const uint32 LowerBits = Bit - 1;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if(Axes[Axis] & Bit)
+			{
+				Axes[0] ^= LowerBits;
+			}
+			else
+			{
+				const uint32 Swap = (Axes[0] ^ Axes[Axis]) & LowerBits;
+				Axes[0] ^= Swap;
+				Axes[Axis] ^= Swap;
+			}
+		}
+	}
+
+	Axes[1] ^= Axes[0];
+	Axes[2] ^= Axes[1];
+	uint32 GrayMask = 0;
+	for (uint32 Bit = 1u << (HilbertBits - 1); Bit > 1; Bit >>= 1)
+	{
+		if(Axes[2] & Bit)
+		{
+			GrayMask ^= Bit - 1;
+		}
+	}
+
+	uint64 Index = 0;
+	for (int32 Bit = HilbertBits - 1; Bit >= 0; --Bit)
+	{
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Index = Index << 1 | ((Axes[Axis] ^ GrayMask) >> Bit & 1);
+		}
+	}
+	return Index;
+}
+
+bool FDungeonTriangulator::InsertPoint(int32 PointIdx)
+{
+	const FVector Point = Points[PointIdx];
+	const int32 ContainingTetra = LocatePoint(Point, LastTetrahedron);
+	if(ContainingTetra == INDEX_NONE)
+	{
+		return false;
+	}
+	for (const int32 Vert : Tetrahedra[ContainingTetra].Verts)
+	{
+		if(Points[Vert] == Point)
+		{
+			return false;
+		}
+	}
+
+	//Grow the cavity from the containing tetrahedron through every neighbour whose circumsphere holds the point.
+	//Neighbours whose shared face can't see the point are taken in too, so the cavity stays star shaped around it
+	++CavityMark;
+	Cavity.Reset();
+	CavityFaces.Reset();
+	Cavity.Add(ContainingTetra);
+	CavityMarks[ContainingTetra] = CavityMark;
+	for (int32 CavityIdx = 0; CavityIdx < Cavity.Num(); ++CavityIdx)
+	{
+		const int32 TetraIdx = Cavity[CavityIdx];
+		const FTetrahedron& Tetra = Tetrahedra[TetraIdx];
+		uint32 UncertainNeighbours = 0;
+		uint32 NeighboursHoldingPoint = CircumSpheres.Contains4(Tetra.Neighbours, Point, UncertainNeighbours);
+		for (int32 Face = 0; UncertainNeighbours != 0; ++Face, UncertainNeighbours >>= 1)
+		{
+			//Too close to the sphere for the doubles to tell, settle it with the exact predicate
+			if((UncertainNeighbours & 1) && InSphere(Tetrahedra[Tetra.Neighbours[Face]], Point) > 0.0)
+			{
+				NeighboursHoldingPoint |= 1u << Face;
+			}
+		}
+		for (int32 Face = 0; Face < 4; ++Face)
+		{
+			const int32 NeighbourIdx = Tetra.Neighbours[Face];
+			if(NeighbourIdx != INDEX_NONE && CavityMarks[NeighbourIdx] == CavityMark)
+			{
+				continue;
+			}
+
+			if(NeighbourIdx != INDEX_NONE && ((NeighboursHoldingPoint & 1u << Face) || OrientWithPoint(Tetra, Face, Point) <= 0.0))
+			{
+				CavityMarks[NeighbourIdx] = CavityMark;
+				Cavity.Add(NeighbourIdx);
+				continue;
+			}
+
+			FCavityFace& CavityFace = CavityFaces.AddDefaulted_GetRef();
+			FMemory::Memcpy(CavityFace.Verts, Tetra.Verts, sizeof(CavityFace.Verts));
+			CavityFace.Verts[Face] = PointIdx;
+			CavityFace.Face = Face;
+			CavityFace.Neighbour = NeighbourIdx;
+			CavityFace.NeighbourFace = INDEX_NONE;
+			if(NeighbourIdx != INDEX_NONE)
+			{
+				const FTetrahedron& Neighbour = Tetrahedra[NeighbourIdx];
+				for (int32 NeighbourFace = 0; NeighbourFace < 4; ++NeighbourFace)
+				{
+					if(Neighbour.Neighbours[NeighbourFace] == TetraIdx)
+					{
+						CavityFace.NeighbourFace = NeighbourFace;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	//Faces recorded before their neighbour got pulled into the cavity are now inside it
+	CavityFaces.RemoveAll([this](const FCavityFace& CavityFace)
+	{
+		return CavityFace.Neighbour != INDEX_NONE && CavityMarks[CavityFace.Neighbour] == CavityMark;
+	});
+
+	for (const int32 TetraIdx : Cavity)
+	{
+		FreeTetrahedron(TetraIdx);
+	}
+
+	//Fill the cavity connecting every boundary face to the point
+	TArray<int32, TInlineAllocator<64>> NewTetrahedra;
+	for (const FCavityFace& CavityFace : CavityFaces)
+	{
+		const int32 NewTetraIdx = AllocateTetrahedron(CavityFace.Verts);
+		NewTetrahedra.Add(NewTetraIdx);
+		Tetrahedra[NewTetraIdx].Neighbours[CavityFace.Face] = CavityFace.Neighbour;
+		if(CavityFace.Neighbour != INDEX_NONE)
+		{
+			Tetrahedra[CavityFace.Neighbour].Neighbours[CavityFace.NeighbourFace] = NewTetraIdx;
+		}
+	}
+
+	//New tetrahedra sharing a boundary edge are neighbours across the face made by that edge and the point. Every
+	//boundary edge shows up exactly twice, the first face waits in an open addressing table keyed by its edge
+	const int32 TableSize = FMath::RoundUpToPowerOfTwo(CavityFaces.Num() * 4);
+	const uint32 TableMask = TableSize - 1;
+	OpenFaces.Reset();
+	OpenFaces.SetNumUninitialized(TableSize, EAllowShrinking::No);
+	for (FOpenFace& OpenFace : OpenFaces)
+	{
+		OpenFace.Edge = MAX_uint64;
+	}
+	for (int32 CavityFaceIdx = 0; CavityFaceIdx < CavityFaces.Num(); ++CavityFaceIdx)
+	{
+		const FCavityFace& CavityFace = CavityFaces[CavityFaceIdx];
+		for (int32 Face = 0; Face < 4; ++Face)
+		{
+			if(Face == CavityFace.Face)
+			{
+				continue;
+			}
+			//The face holds the point plus the two boundary vertices that are neither the opposite one nor the point
+			const int32 EdgeStart = CavityFace.Verts[(Face + 1) & 3] == PointIdx ? CavityFace.Verts[(Face + 3) & 3] : CavityFace.Verts[(Face + 1) & 3];
+			const int32 EdgeEnd = CavityFace.Verts[(Face + 2) & 3] == PointIdx ? CavityFace.Verts[(Face + 3) & 3] : CavityFace.Verts[(Face + 2) & 3];
+			const uint64 Edge = MakeEdge(EdgeStart, EdgeEnd);
+			const int32 NewTetraIdx = NewTetrahedra[CavityFaceIdx];
+
+			uint32 Slot = static_cast<uint32>((Edge * 0x9E3779B97F4A7C15ull) >> 32) & TableMask;
+			while (OpenFaces[Slot].Edge != MAX_uint64 && OpenFaces[Slot].Edge != Edge)
+			{
+				Slot = (Slot + 1) & TableMask;
+			}
+
+			FOpenFace& OpenFace = OpenFaces[Slot];
+			if(OpenFace.Edge == MAX_uint64)
+			{
+				OpenFace.Edge = Edge;
+				OpenFace.Tetra = NewTetraIdx;
+				OpenFace.Face = Face;
+				continue;
+			}
+			Tetrahedra[NewTetraIdx].Neighbours[Face] = OpenFace.Tetra;
+			Tetrahedra[OpenFace.Tetra].Neighbours[OpenFace.Face] = NewTetraIdx;
+		}
+	}
+
+	LastTetrahedron = NewTetrahedra.Last();
+	return true;
+}
+
+int32 FDungeonTriangulator::LocatePoint(const FVector& Point, int32 StartTetra) const
+{
+	//Visibility walk: step through any face the point is behind. Faces are tried from a random one so the walk
+	//can't cycle around the point
+	int32 TetraIdx = StartTetra;
+	const int32 MaxSteps = Tetrahedra.Num();
+	for (int32 Step = 0; Step < MaxSteps && TetraIdx != INDEX_NONE; ++Step)
+	{
+		const FTetrahedron& Tetra = Tetrahedra[TetraIdx];
+		const int32 FirstFace = WalkRandomStream.RandHelper(4);
+		int32 NextTetra = TetraIdx;
+		for (int32 FaceOffset = 0; FaceOffset < 4; ++FaceOffset)
+		{
+			const int32 Face = (FirstFace + FaceOffset) & 3;
+			if(OrientWithPoint(Tetra, Face, Point) < 0.0)
+			{
+				NextTetra = Tetra.Neighbours[Face];
+				break;
+			}
+		}
+		if(NextTetra == TetraIdx)
+		{
+			return TetraIdx;
+		}
+		TetraIdx = NextTetra;
+	}
+
+	//The walk can only get lost on degenerate input, fall back to checking every tetrahedron. Removed ones have empty spheres
+	return CircumSpheres.FindContaining(Point);
+}
+
+int32 FDungeonTriangulator::AllocateTetrahedron(const int32 (&Verts)[4])
+{
+	const FTetrahedron NewTetra(Verts[0], Verts[1], Verts[2], Verts[3]);
+	int32 TetraIdx;
+	if(!FreeTetrahedra.IsEmpty())
+	{
+		TetraIdx = FreeTetrahedra.Pop(EAllowShrinking::No);
+		Tetrahedra[TetraIdx] = NewTetra;
+	}
+	else
+	{
+		CavityMarks.Add(0);
+		CircumSpheres.Add();
+		TetraIdx = Tetrahedra.Add(NewTetra);
+	}
+	CircumSpheres.Set(TetraIdx, Points[Verts[0]], Points[Verts[1]], Points[Verts[2]], Points[Verts[3]]);
+	return TetraIdx;
+}
+
+void FDungeonTriangulator::FreeTetrahedron(int32 TetraIdx)
+{
+	Tetrahedra[TetraIdx].bIsDead = true;
+	CircumSpheres.Clear(TetraIdx);
+	FreeTetrahedra.Add(TetraIdx);
+}
+
+double FDungeonTriangulator::OrientWithPoint(const FTetrahedron& Tetra, int32 Face, const FVector& Point) const
+{
+	const FVector& V0 = Face == 0 ? Point : Points[Tetra.Verts[0]];
+	const FVector& V1 = Face == 1 ? Point : Points[Tetra.Verts[1]];
+	const FVector& V2 = Face == 2 ? Point : Points[Tetra.Verts[2]];
+	const FVector& V3 = Face == 3 ? Point : Points[Tetra.Verts[3]];
+	return DungeonPredicates::Orient(V0, V1, V2, V3);
+}
+
+double FDungeonTriangulator::InSphere(const FTetrahedron& Tetra, const FVector& Point) const
+{
+	return DungeonPredicates::InSphere(Points[Tetra.Verts[0]], Points[Tetra.Verts[1]], Points[Tetra.Verts[2]], Points[Tetra.Verts[3]], Point);
+}
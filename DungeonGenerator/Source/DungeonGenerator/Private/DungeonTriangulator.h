@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TriangulatorData.h"
+
+/**
+ * Incremental 3D Delaunay triangulation (Bowyer-Watson). Tetrahedra keep their face neighbours so each insertion only
+ * touches the tetrahedra around the new point: the containing one is found walking from the last one created and the
+ * cavity grows from it through its neighbours. Slots of removed tetrahedra are reused by the next insertion.
+ */
+class DUNGEONGENERATOR_API FDungeonTriangulator
+{
+public:
+	//Bits per axis of the grid the points are snapped to when sorting them along a Hilbert curve
+	static constexpr int32 HilbertBits = 21;
+	//Insertion rounds are halved until they are this small, the remaining points go first
+	static constexpr int32 BRIOMinRoundSize = 64;
+
+	/** Triangulates the points. Four super vertices enclosing them are added after the last point. */
+	void Triangulate(TConstArrayView<FVector> InPoints);
+	/** Same, with the super vertices built around SuperBounds instead of the points. Triangulations of subsets of a point set
+	 * share the super vertices when given the bounds of the whole set. */
+	void Triangulate(TConstArrayView<FVector> InPoints, const FBox& SuperBounds);
+	void Reset();
+
+	/** Every tetrahedron slot, the ones removed during the triangulation are flagged as dead. */
+	const TArray<FTetrahedron>& GetTetrahedra() const { return Tetrahedra; }
+	int32 GetNumTetrahedra() const { return Tetrahedra.Num() - FreeTetrahedra.Num(); }
+	/** Vertices of the enclosing tetrahedron, not part of the triangulated points. */
+	bool IsSuperVertex(int32 Vert) const { return Vert >= NumPoints; }
+	/** Triangulated points followed by the super vertices. */
+	const TArray<FVector>& GetPoints() const { return Points; }
+	const FCircumSphereTable& GetCircumSpheres() const { return CircumSpheres; }
+	/** Edges between triangulated points as MakeEdge keys, sorted and unique. */
+	void GetEdges(TArray<uint64>& OutEdges) const;
+
+	/** Edge key of two vertices, the lower index goes in the high bits so keys sort like the vertex pairs. */
+	static uint64 MakeEdge(int32 VertA, int32 VertB)
+	{
+		return static_cast<uint64>(FMath::Min(VertA, VertB)) << 32 | static_cast<uint32>(FMath::Max(VertA, VertB));
+	}
+	/** Sorts the edge keys and drops the repeated ones. */
+	static void SortUniqueEdges(TArray<uint64>& InOutEdges);
+	/** Vertices of the tetrahedron enclosing the points in SuperBounds, in the order they are added after the points. */
+	static void AppendSuperVertices(const FBox& SuperBounds, TArray<FVector>& OutPoints);
+
+private:
+	void CreateSuperTetrahedron(const FBox& SuperBounds);
+	/** Spatially coherent order the points are inserted in. The triangulation doesn't depend on it. */
+	void MakeInsertionOrder(TArray<int32>& OutOrder) const;
+	static uint64 HilbertIndex(uint32 X, uint32 Y, uint32 Z);
+	bool InsertPoint(int32 PointIdx);
+	int32 LocatePoint(const FVector& Point, int32 StartTetra) const;
+	int32 AllocateTetrahedron(const int32 (&Verts)[4]);
+	void FreeTetrahedron(int32 TetraIdx);
+
+	/** Orientation of the tetrahedron with one of its vertices replaced by Point. Tetrahedra are kept positive. */
+	double OrientWithPoint(const FTetrahedron& Tetra, int32 Face, const FVector& Point) const;
+	/** Exact in sphere test, positive when Point is inside the circumsphere of the tetrahedron. */
+	double InSphere(const FTetrahedron& Tetra, const FVector& Point) const;
+
+	TArray<FVector> Points;
+	int32 NumPoints = 0;
+	TArray<FTetrahedron> Tetrahedra;
+	FCircumSphereTable CircumSpheres;
+	TArray<int32> FreeTetrahedra;
+	int32 LastTetrahedron = INDEX_NONE;
+
+	//Insertion scratch, kept between insertions to avoid reallocating
+	struct FCavityFace
+	{
+		//Vertices of the new tetrahedron, the cavity tetrahedron ones with the face opposite vertex replaced by the point
+		int32 Verts[4];
+		//Vertex replaced by the point, the new tetrahedron shares this face with Neighbour
+		int32 Face;
+		int32 Neighbour;
+		int32 NeighbourFace;
+	};
+	//Face of a new tetrahedron still waiting for its neighbour, identified by the sorted vertex indices of the boundary
+	//edge it holds. MAX_uint64 marks an empty slot
+	struct FOpenFace
+	{
+		uint64 Edge;
+		int32 Tetra;
+		int32 Face;
+	};
+	TArray<int32> Cavity;
+	TArray<FCavityFace> CavityFaces;
+	TArray<FOpenFace> OpenFaces;
+	TArray<uint32> CavityMarks;
+	uint32 CavityMark = 0;
+	FRandomStream WalkRandomStream;
+};
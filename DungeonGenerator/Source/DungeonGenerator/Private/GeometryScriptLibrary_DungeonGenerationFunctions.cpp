@@ -3,6 +3,7 @@
 
 #include "GeometryScriptLibrary_DungeonGenerationFunctions.h"
 
+#include "DungeonGeneratorStats.h"
 #include "DynamicMeshEditor.h"
 #include "UDynamicMesh.h"
 #include "DynamicMesh/MeshTransforms.h"
@@ -609,6 +610,7 @@ UDynamicMesh* UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallowedB
                                                                                    float DimensionZ, float WallThickness, bool OpenEdges, int32 StepsX, int32 StepsY,
                                                                                    int32 StepsZ, EGeometryScriptPrimitiveOriginMode Origin, UGeometryScriptDebug* Debug)
 {
+	SCOPE_DUNGEON_STAT(STAT_AppendHallowedBox);
 	if (TargetMesh == nullptr)
 	{
 		UE::Geometry::AppendError(Debug, EGeometryScriptErrorType::InvalidInputs, LOCTEXT("DungeonGenerationFunctions::AppendHallowedBox", "AppendHallowedBox: TargetMesh is Null"));
@@ -643,6 +645,7 @@ UDynamicMesh* UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallowedB
 				);
 
 	FGeometryScriptMeshBooleanOptions BoolOptions;
+	INC_DWORD_STAT(STAT_BooleanOperations);
 	UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 				(
 					TargetMesh,
@@ -660,6 +663,7 @@ UDynamicMesh* UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallwayCo
 	float DimensionZ, float WallThickness, bool OpenEdges,
 	UGeometryScriptDebug* Debug)
 {
+	SCOPE_DUNGEON_STAT(STAT_AppendHallwayCorner);
 	if (TargetMesh == nullptr)
 	{
 		UE::Geometry::AppendError(Debug, EGeometryScriptErrorType::InvalidInputs, LOCTEXT("PrimitiveFunctions_AppendHallwayCorner", "AppendHallwayCorner: TargetMesh is Null"));
@@ -699,6 +703,7 @@ UDynamicMesh* UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallwayCo
 	AppendPrimitive(BoolMesh, &CornerGenerator, PrimitiveOptions);
 	
 	FGeometryScriptMeshBooleanOptions BoolOptions;
+	INC_DWORD_STAT(STAT_BooleanOperations);
 	UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 				(
 					TargetMesh,
@@ -716,6 +721,7 @@ UDynamicMesh* UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallway(U
                                                                                         FGeometryScriptPrimitiveOptions PrimitiveOptions, FVector Start, FVector End, float DimensionY,
                                                                                         float DimensionZ, float WallThickness, bool OpenEdges, int32 StepsX, int32 StepsY, int32 StepsZ, UGeometryScriptDebug* Debug)
 {
+	SCOPE_DUNGEON_STAT(STAT_AppendHallway);
 	if (TargetMesh == nullptr)
 	{
 		UE::Geometry::AppendError(Debug, EGeometryScriptErrorType::InvalidInputs, LOCTEXT("PrimitiveFunctions_AppendStaircaseHallway", "AppendStaircaseHallway: TargetMesh is Null"));
@@ -750,6 +756,7 @@ UDynamicMesh* UGeometryScriptLibrary_DungeonGenerationFunctions::AppendHallway(U
 	AppendPrimitive(BoolMesh, &HallwayGenerator, PrimitiveOptions);
 	
 	FGeometryScriptMeshBooleanOptions BoolOptions;
+	INC_DWORD_STAT(STAT_BooleanOperations);
 	UGeometryScriptLibrary_MeshBooleanFunctions::ApplyMeshBoolean
 				(
 					TargetMesh,
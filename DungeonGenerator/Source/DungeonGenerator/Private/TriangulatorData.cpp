@@ -5,93 +5,147 @@
 
 #include "DungeonMapperData.h"
 
-bool FTetrahedron::ContainsVert(const UDungeonRoomData* Vert) const
+bool FTetrahedron::ContainsVert(int32 Vert) const
 {
-	return Vert->Location.Equals(Vert1->Location) || Vert->Location.Equals(Vert2->Location) || Vert->Location.Equals(Vert3->Location) || Vert->Location.Equals(Vert4->Location);
+	return Verts[0] == Vert || Verts[1] == Vert || Verts[2] == Vert || Verts[3] == Vert;
 }
 
-bool FTetrahedron::ContainsVert(const FVector& Vert) const
+void FCircumSphereTable::Reset()
 {
-	return Vert.Equals(Vert1->Location) || Vert.Equals(Vert2->Location) || Vert.Equals(Vert3->Location) || Vert.Equals(Vert4->Location);
+	CenterX.Reset();
+	CenterY.Reset();
+	CenterZ.Reset();
+	RadiusSqr.Reset();
+	Tolerance.Reset();
 }
 
-bool FTetrahedron::CircumSphereContains(const UDungeonRoomData* Vert) const
+void FCircumSphereTable::Reserve(int32 Number)
 {
-	const float Dist = FVector::DistSquared(Vert->Location, CircumCenter);
-	return Dist <= CircumCenterSqrt;
+	CenterX.Reserve(Number);
+	CenterY.Reserve(Number);
+	CenterZ.Reserve(Number);
+	RadiusSqr.Reserve(Number);
+	Tolerance.Reserve(Number);
 }
 
-bool FTetrahedron::CircumSphereContains(const FVector& Vert) const
+int32 FCircumSphereTable::Add()
 {
-	const float Dist = FVector::DistSquared(Vert, CircumCenter);
-	return Dist <= CircumCenterSqrt;
+	CenterX.Add(0.0);
+	CenterY.Add(0.0);
+	CenterZ.Add(0.0);
+	Tolerance.Add(0.0);
+	return RadiusSqr.Add(-1.0);
 }
 
-void FTetrahedron::CalculateCircumSphere()
+void FCircumSphereTable::Set(int32 TetraIdx, const FVector& A, const FVector& B, const FVector& C, const FVector& D)
 {
-	const FVector Location1 = Vert1->Location;
-	const FVector Location2 = Vert2->Location;
-	const FVector Location3 = Vert3->Location;
-	const FVector Location4 = Vert4->Location;
-
-	const float A = UE::Math::TMatrix<double>
-	(
-		UE::Math::TPlane(FVector4(Location1.X, Location2.X, Location3.X, Location4.X)),
-		UE::Math::TPlane(FVector4(Location1.Y,Location2.Y, Location3.Y, Location4.Y)),
-		UE::Math::TPlane(FVector4(Location1.Z, Location2.Z, Location3.Z, Location4.Z)),
-		UE::Math::TPlane(FVector4(1, 1, 1, 1))
-		).Determinant();
-
-	const float V1SizeSqr = Location1.SizeSquared();
-	const float V2SizeSqr = Location2.SizeSquared();
-	const float V3SizeSqr = Location3.SizeSquared();
-	const float V4SizeSqr = Location4.SizeSquared();
-
-	const float DX = UE::Math::TMatrix<double>
-	(
-		UE::Math::TPlane(FVector4(V1SizeSqr, V2SizeSqr, V3SizeSqr, V4SizeSqr)),
-		UE::Math::TPlane(FVector4(Location1.Y, Location2.Y, Location3.Y, Location4.Y)),
-		UE::Math::TPlane(FVector4(Location1.Z, Location2.Z, Location3.Z, Location4.Z)),
-		UE::Math::TPlane(FVector4(1, 1, 1, 1))
-		).Determinant();
-
-	const float DY = -(UE::Math::TMatrix<double>
-	(
-		UE::Math::TPlane(FVector4(V1SizeSqr, V2SizeSqr, V3SizeSqr, V4SizeSqr)),
-		UE::Math::TPlane(FVector4(Location1.X, Location2.X, Location3.X, Location4.X)),
-		UE::Math::TPlane(FVector4(Location1.Z, Location2.Z, Location3.Z, Location4.Z)),
-		UE::Math::TPlane(FVector4(1, 1, 1, 1))
-		).Determinant());
-
-	const float DZ = UE::Math::TMatrix<double>
-	(
-		UE::Math::TPlane(FVector4(V1SizeSqr, V2SizeSqr, V3SizeSqr, V4SizeSqr)),
-		UE::Math::TPlane(FVector4(Location1.X, Location2.X, Location3.X, Location4.X)),
-		UE::Math::TPlane(FVector4(Location1.Y, Location2.Y, Location3.Y, Location4.Y)),
-		UE::Math::TPlane(FVector4(1, 1, 1, 1))
-		).Determinant();
-
-	const float C = UE::Math::TMatrix<double>
-	(
-		UE::Math::TPlane(FVector4(V1SizeSqr, V2SizeSqr, V3SizeSqr, V4SizeSqr)),
-		UE::Math::TPlane(FVector4(Location1.X, Location2.X, Location3.X, Location4.X)),
-		UE::Math::TPlane(FVector4(Location1.Y, Location2.Y, Location3.Y, Location4.Y)),
-		UE::Math::TPlane(FVector4(Location1.Z, Location2.Z, Location3.Z, Location4.Z))
-		).Determinant();
-
-	CircumCenter = FVector(
-		DX/(2*A),
-		DY/(2*A),
-		DZ/(2*A)
-		);
-	
-	CircumCenterSqrt =  ((DX * DX) + (DY * DY) + (DZ * DZ) - (4 * A * C)) / (4 * A * A);
+	FVector Center;
+	double SphereRadiusSqr, SphereTolerance;
+	if(!ComputeSphere(A, B, C, D, Center, SphereRadiusSqr, SphereTolerance))
+	{
+		//Flat tetrahedron, every test against it goes to the exact predicate
+		Clear(TetraIdx);
+		Tolerance[TetraIdx] = MAX_dbl;
+		return;
+	}
+
+	CenterX[TetraIdx] = Center.X;
+	CenterY[TetraIdx] = Center.Y;
+	CenterZ[TetraIdx] = Center.Z;
+	RadiusSqr[TetraIdx] = SphereRadiusSqr;
+	Tolerance[TetraIdx] = SphereTolerance;
 }
 
-bool FTriangle::AlmostEqual(const FTriangle& T1, const FTriangle& T2)
+bool FCircumSphereTable::ComputeSphere(const FVector& A, const FVector& B, const FVector& C, const FVector& D, FVector& OutCenter, double& OutRadiusSqr, double& OutTolerance)
 {
-	const bool DupV1 = T1.Vert1->Location.Equals(T2.Vert1->Location) ||  T1.Vert1->Location.Equals(T2.Vert2->Location) ||  T1.Vert1->Location.Equals(T2.Vert3->Location);
-	const bool DupV2 = T1.Vert2->Location.Equals(T2.Vert1->Location) ||  T1.Vert2->Location.Equals(T2.Vert2->Location) ||  T1.Vert2->Location.Equals(T2.Vert3->Location);
-	const bool DupV3 = T1.Vert3->Location.Equals(T2.Vert1->Location) ||  T1.Vert3->Location.Equals(T2.Vert2->Location) ||  T1.Vert3->Location.Equals(T2.Vert3->Location);
-	return DupV1 && DupV2 && DupV3;
-}
\ No newline at end of file
+	//Closed form relative to A: (|b|^2 (c x d) + |c|^2 (d x b) + |d|^2 (b x c)) / (2 b.(c x d))
+	const FVector AB = B - A;
+	const FVector AC = C - A;
+	const FVector AD = D - A;
+	const FVector CrossCD = AC ^ AD;
+	const double Denominator = 2.0 * (AB | CrossCD);
+	const FVector Offset = (CrossCD * AB.SizeSquared() + (AD ^ AB) * AC.SizeSquared() + (AB ^ AC) * AD.SizeSquared()) / Denominator;
+	const double Radius = Offset.Size();
+	//The center error grows with how flat the tetrahedron is and with how far from the origin it is
+	const double Conditioning = FMath::Sqrt(AB.SizeSquared() * AC.SizeSquared() * AD.SizeSquared()) / FMath::Abs(Denominator);
+	OutTolerance = ToleranceScale * (Conditioning * Radius * Radius + 4.0 * Radius * A.GetAbsMax());
+	if(!FMath::IsFinite(OutTolerance))
+	{
+		return false;
+	}
+
+	OutCenter = A + Offset;
+	OutRadiusSqr = Radius * Radius;
+	return true;
+}
+
+void FCircumSphereTable::Clear(int32 TetraIdx)
+{
+	CenterX[TetraIdx] = 0.0;
+	CenterY[TetraIdx] = 0.0;
+	CenterZ[TetraIdx] = 0.0;
+	RadiusSqr[TetraIdx] = -1.0;
+	Tolerance[TetraIdx] = 0.0;
+}
+
+bool FCircumSphereTable::Contains(int32 TetraIdx, const FVector& Point) const
+{
+	const double DX = Point.X - CenterX[TetraIdx];
+	const double DY = Point.Y - CenterY[TetraIdx];
+	const double DZ = Point.Z - CenterZ[TetraIdx];
+	return DX * DX + DY * DY + DZ * DZ < RadiusSqr[TetraIdx];
+}
+
+uint32 FCircumSphereTable::Contains4(const int32 (&TetraIndices)[4], const FVector& Point, uint32& OutUncertain) const
+{
+	//Missing tetrahedra read slot 0 and get masked out at the end
+	const int32 I0 = FMath::Max(TetraIndices[0], 0);
+	const int32 I1 = FMath::Max(TetraIndices[1], 0);
+	const int32 I2 = FMath::Max(TetraIndices[2], 0);
+	const int32 I3 = FMath::Max(TetraIndices[3], 0);
+	const VectorRegister4Double DX = VectorSubtract(VectorSetFloat1(Point.X), MakeVectorRegisterDouble(CenterX[I0], CenterX[I1], CenterX[I2], CenterX[I3]));
+	const VectorRegister4Double DY = VectorSubtract(VectorSetFloat1(Point.Y), MakeVectorRegisterDouble(CenterY[I0], CenterY[I1], CenterY[I2], CenterY[I3]));
+	const VectorRegister4Double DZ = VectorSubtract(VectorSetFloat1(Point.Z), MakeVectorRegisterDouble(CenterZ[I0], CenterZ[I1], CenterZ[I2], CenterZ[I3]));
+	const VectorRegister4Double DistSqr = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+	const VectorRegister4Double Radii = MakeVectorRegisterDouble(RadiusSqr[I0], RadiusSqr[I1], RadiusSqr[I2], RadiusSqr[I3]);
+	const VectorRegister4Double Tolerances = MakeVectorRegisterDouble(Tolerance[I0], Tolerance[I1], Tolerance[I2], Tolerance[I3]);
+
+	uint32 ValidMask = 0;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		ValidMask |= TetraIndices[i] != INDEX_NONE ? 1u << i : 0u;
+	}
+	const uint32 Inside = VectorMaskBits(VectorCompareLT(VectorAdd(DistSqr, Tolerances), Radii)) & ValidMask;
+	const uint32 Outside = VectorMaskBits(VectorCompareGT(DistSqr, VectorAdd(Radii, Tolerances))) & ValidMask;
+	OutUncertain = ValidMask & ~(Inside | Outside);
+	return Inside;
+}
+
+int32 FCircumSphereTable::FindContaining(const FVector& Point) const
+{
+	const VectorRegister4Double PointX = VectorSetFloat1(Point.X);
+	const VectorRegister4Double PointY = VectorSetFloat1(Point.Y);
+	const VectorRegister4Double PointZ = VectorSetFloat1(Point.Z);
+	const int32 Count = Num();
+	int32 TetraIdx = 0;
+	for (; TetraIdx + 4 <= Count; TetraIdx += 4)
+	{
+		const VectorRegister4Double DX = VectorSubtract(PointX, VectorLoad(&CenterX[TetraIdx]));
+		const VectorRegister4Double DY = VectorSubtract(PointY, VectorLoad(&CenterY[TetraIdx]));
+		const VectorRegister4Double DZ = VectorSubtract(PointZ, VectorLoad(&CenterZ[TetraIdx]));
+		const VectorRegister4Double DistSqr = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+		const int32 Inside = VectorMaskBits(VectorCompareLT(DistSqr, VectorLoad(&RadiusSqr[TetraIdx])));
+		if(Inside)
+		{
+			return TetraIdx + FMath::CountTrailingZeros(static_cast<uint32>(Inside));
+		}
+	}
+	for (; TetraIdx < Count; ++TetraIdx)
+	{
+		if(Contains(TetraIdx, Point))
+		{
+			return TetraIdx;
+		}
+	}
+	return INDEX_NONE;
+}
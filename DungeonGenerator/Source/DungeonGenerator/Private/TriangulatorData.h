@@ -10,77 +10,63 @@ struct FDungeonNode;
 struct FTetrahedron
 {
 	FTetrahedron()
-	: Vert1(nullptr)
-	, Vert2(nullptr)
-	, Vert3(nullptr)
-	, Vert4(nullptr)
-	, bIsBad(false)
-	, CircumCenterSqrt(0)
+	: bIsDead(false)
 	{
+		Verts[0] = Verts[1] = Verts[2] = Verts[3] = INDEX_NONE;
+		Neighbours[0] = Neighbours[1] = Neighbours[2] = Neighbours[3] = INDEX_NONE;
 	}
 
-	FTetrahedron(UDungeonRoomData* Vert1, UDungeonRoomData* Vert2, UDungeonRoomData* Vert3, UDungeonRoomData* Vert4)
-		: Vert1(Vert1),
-		  Vert2(Vert2),
-		  Vert3(Vert3),
-		  Vert4(Vert4)
+	FTetrahedron(int32 Vert1, int32 Vert2, int32 Vert3, int32 Vert4)
+	: bIsDead(false)
 	{
-		CalculateCircumSphere();
+		Verts[0] = Vert1;
+		Verts[1] = Vert2;
+		Verts[2] = Vert3;
+		Verts[3] = Vert4;
+		Neighbours[0] = Neighbours[1] = Neighbours[2] = Neighbours[3] = INDEX_NONE;
 	}
 
-	FTetrahedron(const FVector& Vert1, const FVector& Vert2, const FVector& Vert3, const FVector& Vert4)
-	: Vert1(nullptr)
-	, Vert2(nullptr)
-	, Vert3(nullptr)
-	, Vert4(nullptr)
-	{
-		CalculateCircumSphere();
-	}
-	
-	bool ContainsVert(const UDungeonRoomData* Vert) const;
-	bool ContainsVert(const FVector& Vert) const;
-	bool CircumSphereContains(const UDungeonRoomData* Vert) const;
-	bool CircumSphereContains(const FVector& Vert) const;
-	
-	UDungeonRoomData* Vert1;
-	UDungeonRoomData* Vert2;
-	UDungeonRoomData* Vert3;
-	UDungeonRoomData* Vert4;
-
-	
-	bool bIsBad;
+	bool ContainsVert(int32 Vert) const;
 
-	FVector CircumCenter;
-	float CircumCenterSqrt;
+	//Indices into the triangulated points, positively oriented
+	int32 Verts[4];
+	//Tetrahedron across the face opposite to each vertex, INDEX_NONE on the hull
+	int32 Neighbours[4];
 
-private:
-	void CalculateCircumSphere();
+	bool bIsDead;
 };
 
-
-struct FTriangle
+/**
+ * Circumspheres of the tetrahedra, indexed like them. Centers and squared radii are kept as structure of arrays so a
+ * point is tested against four spheres at once. Each sphere has a tolerance covering its rounding error, points that
+ * close to it are reported as uncertain and have to be settled with DungeonPredicates::InSphere.
+ */
+struct FCircumSphereTable
 {
-	FTriangle()
-	: Vert1(nullptr)
-	, Vert2(nullptr)
-	, Vert3(nullptr)
-	, bIsBad(false)
-	{
-	}
+	//Relative rounding error assumed for a circumsphere, a few thousand ulps
+	static constexpr double ToleranceScale = 1e-12;
 
-	FTriangle(UDungeonRoomData* Vert1, UDungeonRoomData* Vert2, UDungeonRoomData* Vert3)
-	: Vert1(Vert1)
-	, Vert2(Vert2)
-	, Vert3(Vert3)
-	, bIsBad(false)
-	{
-	}
-	
-	static bool AlmostEqual(const FTriangle& T1, const FTriangle& T2);
-	
-	UDungeonRoomData* Vert1;
-	UDungeonRoomData* Vert2;
-	UDungeonRoomData* Vert3;
-	
-	bool bIsBad;
-};
\ No newline at end of file
+	void Reset();
+	void Reserve(int32 Number);
+	/** Makes room for one more tetrahedron, returns its index. */
+	int32 Add();
+	void Set(int32 TetraIdx, const FVector& A, const FVector& B, const FVector& C, const FVector& D);
+	/** Circumsphere of ABCD and the tolerance of distances squared against it. False for flat tetrahedra. */
+	static bool ComputeSphere(const FVector& A, const FVector& B, const FVector& C, const FVector& D, FVector& OutCenter, double& OutRadiusSqr, double& OutTolerance);
+	/** Removed tetrahedra get an empty sphere so scans skip them. */
+	void Clear(int32 TetraIdx);
+
+	bool Contains(int32 TetraIdx, const FVector& Point) const;
+	/** Bit i is set when Point is clearly inside the sphere of TetraIndices[i]. INDEX_NONE entries are never inside. */
+	uint32 Contains4(const int32 (&TetraIndices)[4], const FVector& Point, uint32& OutUncertain) const;
+	/** First tetrahedron whose sphere holds Point, INDEX_NONE if none. */
+	int32 FindContaining(const FVector& Point) const;
+
+	int32 Num() const { return RadiusSqr.Num(); }
+
+	TArray<double> CenterX;
+	TArray<double> CenterY;
+	TArray<double> CenterZ;
+	TArray<double> RadiusSqr;
+	TArray<double> Tolerance;
+};